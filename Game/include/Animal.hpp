@@ -1,10 +1,12 @@
 #pragma once
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
+#include <optional>
 #include <Framework/GameObjects/AnimatedSprite.hpp>
 #include <Framework/Pathfinding/PathFindingGrid.hpp>
 #include <Framework/BehaviourTrees/BehaviourTree.hpp>
-#include <Framework/BehaviourTrees/Actions/FindClosestNavigatable.hpp>
 
 enum class FoodClass { Herbivore, Omnivore, Carnivore };
 
@@ -13,8 +15,8 @@ class Animal : public Framework::AnimatedSprite
 {
 	friend class Game;
 
-	// Decision-making
-	std::unique_ptr<Framework::BehaviourTree> m_BehaviourTree;
+	// Decision-making, stored inline so the tree lives in the same pooled block as the Animal
+	std::optional<Framework::BehaviourTree> m_BehaviourTree;
 	// Pathfinding
 	Framework::Pathfinding::Grid<Framework::Pathfinding::SquareGridNode>* m_Grid;
 
@@ -24,26 +26,31 @@ class Animal : public Framework::AnimatedSprite
 
 	void Init();
 
-	void CreateBehaviourWander();
-	void CreateBehaviourCheckFood();
-	void CreateBehaviourCheckDeath();
-	void CreateBehaviourCheckWater();
-	void CreateBehaviourCheckPredator();
-	Framework::BT::FindClosestNavigatable* AddFindClosestNavigatable
-				(Framework::BT::Sequence* parent, std::vector<std::string> tags);
+	// Tree nodes are shared by every animal of the same food class
+	static std::map<FoodClass, std::shared_ptr<Framework::BehaviourTreeDefinition>> s_BehaviourDefinitions;
+	static std::shared_ptr<Framework::BehaviourTreeDefinition> GetBehaviourDefinition
+				(FoodClass foodClass, Framework::Pathfinding::Grid<Framework::Pathfinding::SquareGridNode>* grid);
+
+	// Named functions used by behaviour tree files in assets/Behaviours
+	static void RegisterBehaviourCallbacks();
 
 protected:
-	Framework::BehaviourTree* GetBehaviourTree() { return m_BehaviourTree.get(); }
+	Framework::BehaviourTree* GetBehaviourTree() { return m_BehaviourTree ? &*m_BehaviourTree : nullptr; }
 
 public:
 	Animal(GameObject* parent = nullptr);
 	Animal(Texture texture, GameObject* parent = nullptr);
 	Animal(std::string texturePath, GameObject* parent = nullptr);
+	virtual ~Animal();
 
-	// Populates the behaviour tree, with grid passed for pathfinding nodes
+	// Creates behaviour tree from the definition for this animal's food class, with grid passed for pathfinding nodes
 	void InitBehaviourTree(Framework::Pathfinding::Grid<Framework::Pathfinding::SquareGridNode>* grid);
 
+	// Releases shared behaviour tree definitions, call once all animals are destroyed
+	static void ClearBehaviourDefinitions();
+
 	virtual void OnDraw() override;
+	virtual void OnThink() override;
 	virtual void OnUpdate() override;
 
 	// Getters
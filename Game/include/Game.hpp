@@ -1,9 +1,12 @@
 #pragma once
 #include <memory>
+#include <unordered_map>
 #include <Map.hpp>
 #include <Animal.hpp>
 #include <Framework/GameObject.hpp>
 #include <Framework/GameObjects/Sprite.hpp>
+#include <Framework/GameObjects/StaticSpriteLayer.hpp>
+#include <Framework/Pathfinding/InfluenceMap.hpp>
 #include <Framework/Pathfinding/PathFindingGrid.hpp>
 
 using SquareGridNode = Framework::Pathfinding::SquareGridNode;
@@ -45,9 +48,13 @@ class Game
 	Font m_Font;
 	Camera2D m_Camera;
 	Framework::GameObject* m_Root;
-	Framework::GameObject* m_Background;
+	Framework::StaticSpriteLayer* m_Background;
+	Framework::GameObject* m_StaticObjects; // Tagged & collidable map tiles, never updated or drawn
 	std::unique_ptr<PathfindingGrid> m_PathfindingGrid;
 
+	// Sampled by creatures instead of searching, keyed by name registered with InfluenceMap
+	std::unordered_map<std::string, std::unique_ptr<Framework::Pathfinding::InfluenceMap>> m_InfluenceMaps;
+
 	// Background Tiles
 	Texture m_BackgroundSheet;
 	Texture m_SlimeSpriteSheet;
@@ -55,10 +62,13 @@ class Game
 
 	void CreateMap();
 	void CreateCreatureInfos();
+	void CreateInfluenceMaps();
+	void UpdateInfluenceMaps();
 
 	Framework::GameObject* SpawnRandomCreature(Framework::Vec2 position, int index = -1);
-	Framework::GameObject* AddBackgroundTileWaterEdge(unsigned int x, unsigned int y);
-	Framework::GameObject* AddBackgroundTile(unsigned int x, unsigned int y, char c, int spriteIndex = -1);
+	void AddBackgroundTileWaterEdge(unsigned int x, unsigned int y);
+	void AddBackgroundTile(unsigned int x, unsigned int y, char c, int spriteIndex = -1);
+	Framework::GameObject* AddStaticObject(unsigned int x, unsigned int y);
 
 public:
 	Game();
@@ -2,17 +2,16 @@
 #include <algorithm>
 #include <Animal.hpp>
 
-#include <Framework/BehaviourTrees/Actions/Move.hpp>
-#include <Framework/BehaviourTrees/Actions/Wait.hpp>
-#include <Framework/BehaviourTrees/Actions/CanSee.hpp>
+#include <Framework/Logger.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
+#include <Framework/BehaviourTrees/PerceptionService.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeScheduler.hpp>
+#include <Framework/Pathfinding/InfluenceMap.hpp>
+#include <Framework/BehaviourTrees/NodeRegistry.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeLoader.hpp>
 #include <Framework/BehaviourTrees/Actions/FindPath.hpp>
-#include <Framework/BehaviourTrees/Actions/SetValue.hpp>
-#include <Framework/BehaviourTrees/Actions/LimitTime.hpp>
-#include <Framework/BehaviourTrees/Actions/PlaySound.hpp>
-#include <Framework/BehaviourTrees/Actions/MoveTowards.hpp>
 #include <Framework/BehaviourTrees/Actions/CallFunction.hpp>
-#include <Framework/BehaviourTrees/Actions/NavigatePath.hpp>
-#include <Framework/BehaviourTrees/Actions/CanSeeTarget.hpp>
+#include <Framework/BehaviourTrees/Actions/FindClosestNavigatable.hpp>
 
 using namespace std;
 using namespace Framework;
@@ -23,13 +22,21 @@ Animal::Animal(GameObject* parent) : AnimatedSprite(parent) { Init(); }
 Animal::Animal(Texture texture, GameObject* parent) : AnimatedSprite(texture, parent) { Init(); }
 Animal::Animal(string texturePath, GameObject* parent) : AnimatedSprite(texturePath, parent) { Init(); }
 
+Animal::~Animal()
+{
+	if (m_BehaviourTree)
+		BehaviourTreeScheduler::Unregister(&*m_BehaviourTree);
+	PerceptionService::RemoveObserver(this);
+}
+
 void Animal::Init()
 {
 	m_Health = 100.0f;
 	m_Hunger = m_Thirst = 0.0f;
 }
 
-void Animal::OnUpdate()
+// Only touches this animal's needs & animation, safe to run in parallel
+void Animal::OnThink()
 {
 	float deltaTime = GetFrameTime();
 	m_Thirst += Game::ThirstPerSecond * deltaTime;
@@ -44,9 +51,12 @@ void Animal::OnUpdate()
 	m_Thirst = clamp(m_Thirst, 0.0f, 1.0f);
 	m_Hunger = clamp(m_Hunger, 0.0f, 1.0f);
 
-	m_BehaviourTree->Update();
-	Framework::AnimatedSprite::OnUpdate();
+	Framework::AnimatedSprite::OnThink();
+}
 
+// Behaviour tree is ticked by BehaviourTreeScheduler
+void Animal::OnUpdate()
+{
 	// TODO: DEATH CHECK IN BEHAVIOUR TREE (for animation)
 	if (m_Health <= 0.0f)
 		Destroy();
@@ -76,43 +86,116 @@ void Animal::AddHealth(float value) { m_Health = clamp(m_Health + value, -1.0f,
 void Animal::AddThirst(float value) { m_Thirst = clamp(m_Thirst + value, 0.0f, 1.0f); }
 void Animal::AddHunger(float value) { m_Hunger = clamp(m_Hunger + value, 0.0f, 1.0f); }
 
-void Animal::SetSpeed(float value) { m_Speed = value; }
+void Animal::SetSpeed(float value)
+{
+	m_Speed = value;
+	if (m_BehaviourTree)
+		m_BehaviourTree->GetBlackboard()->Set(Keys::Speed, value);
+}
 void Animal::SetHealth(float value) { m_Health = value; }
 void Animal::SetThirst(float value) { m_Thirst = value; }
 void Animal::SetHunger(float value) { m_Hunger = value; }
 void Animal::SetFoodClass(FoodClass foodClass) { m_FoodClass = foodClass; }
 
+map<FoodClass, shared_ptr<BehaviourTreeDefinition>> Animal::s_BehaviourDefinitions;
+
 void Animal::InitBehaviourTree(Grid<SquareGridNode>* grid)
 {
 	m_Grid = grid;
-	m_BehaviourTree = make_unique<BehaviourTree>(this);
-
-	CreateBehaviourCheckDeath();
+	if (m_BehaviourTree)
+		BehaviourTreeScheduler::Unregister(&*m_BehaviourTree);
+	m_BehaviourTree.emplace(this, GetBehaviourDefinition(m_FoodClass, grid));
+	BehaviourTreeScheduler::Register(&*m_BehaviourTree);
+	PerceptionService::AddObserver(this);
 
 	if (m_FoodClass == FoodClass::Herbivore)
-	{
 		AddTag("PassiveCreature");
-		CreateBehaviourCheckPredator();
+
+	// Per-animal values read by shared nodes
+	BT::Blackboard* blackboard = m_BehaviourTree->GetBlackboard();
+	blackboard->Set(Keys::Speed, m_Speed);
+	blackboard->Set(Keys::AStarGrid, grid);
+}
+
+shared_ptr<BehaviourTreeDefinition> Animal::GetBehaviourDefinition(FoodClass foodClass, Grid<SquareGridNode>* grid)
+{
+	auto it = s_BehaviourDefinitions.find(foodClass);
+	if (it != s_BehaviourDefinitions.end())
+		return it->second;
+
+	if (s_BehaviourDefinitions.empty())
+		RegisterBehaviourCallbacks();
+
+	const char* FoodClassNames[] = { "Herbivore", "Omnivore", "Carnivore" };
+	shared_ptr<BehaviourTreeDefinition> definition = make_shared<BehaviourTreeDefinition>(FoodClassNames[(int)foodClass]);
+
+	string path = string("./assets/Behaviours/") + FoodClassNames[(int)foodClass] + ".bt";
+	if (!BehaviourTreeLoader::Load(path, *definition))
+		FRAMEWORK_LOG_ERROR(Logger::NoAgent, "Animal", "Behaviour tree '%s' did not fully load", path.c_str());
+
+	// Pathfinding nodes search their own copy of the grid
+	vector<BehaviourNode*> nodes = { definition->Root() };
+	while (!nodes.empty())
+	{
+		BehaviourNode* node = nodes.back();
+		nodes.pop_back();
+		node->GetChildNodes(nodes);
+
+		if (FindClosestNavigatable* findClosest = dynamic_cast<FindClosestNavigatable*>(node))
+			findClosest->CopyGrid(grid);
+		else if (FindPath* findPath = dynamic_cast<FindPath*>(node))
+			findPath->CopyGrid(grid);
 	}
 
-	CreateBehaviourCheckWater();
-	CreateBehaviourCheckFood();
-	CreateBehaviourWander();
+	s_BehaviourDefinitions.emplace(foodClass, definition);
+	return definition;
 }
 
-void Animal::CreateBehaviourWander()
+void Animal::ClearBehaviourDefinitions() { s_BehaviourDefinitions.clear(); }
+
+// Functions that behaviour tree files refer to by name
+void Animal::RegisterBehaviourCallbacks()
 {
-	auto sequence = m_BehaviourTree->Add<Sequence>();
+	/// --- SCORES --- ///
+	// Needs score their level once past a threshold, the highest scoring branch runs
+	NodeRegistry::RegisterCallback<UtilitySelector::ScoreType>("HungerScore", [](GameObject* go, UtilitySelector*)
+	{
+		float hunger = ((Animal*)go)->GetHunger();
+		return hunger >= 0.5f ? hunger : 0.0f;
+	});
 
-#ifndef NDEBUG
-	sequence->AddChild<Log>()->Message = "Behaviour - Wander";
-#endif
+	NodeRegistry::RegisterCallback<UtilitySelector::ScoreType>("ThirstScore", [](GameObject* go, UtilitySelector*)
+	{
+		float thirst = ((Animal*)go)->GetThirst();
+		return thirst >= 0.4f ? thirst : 0.0f;
+	});
 
+	// Outscores any need when a predator is within a few cells, closer predators score higher
+	NodeRegistry::RegisterCallback<UtilitySelector::ScoreType>("PredatorScore", [](GameObject* go, UtilitySelector*)
+	{
+		const float MinimumDanger = 0.15f;
+		InfluenceMap* danger = InfluenceMap::Find("Danger");
+		float value = danger ? danger->Sample(go->GetPosition()) : 0.0f;
+		return value >= MinimumDanger ? 1.5f + value / 2.0f : 0.0f;
+	});
+
+	// Keep searching for food until a path has been followed to it
+	NodeRegistry::RegisterCallback<Repeat::ConditionType>("SearchingForFood", [](GameObject*, Repeat* caller)
+	{
+		return !caller->ContextExists(Keys::RepeatCount) || caller->ContextExists(Keys::Path);
+	});
+
+	NodeRegistry::RegisterCallback<DynamicLog::MessageType>("ShouldFlee", [](GameObject* go, DynamicLog*)
+	{
+		return "{" + to_string(go->GetID()) + "} should flee!";
+	});
+
+	/// --- MOVEMENT --- ///
 	// Calculate random direction
-	sequence->AddChild<CallFunction>()->Function = [](GameObject* go, CallFunction* caller)
+	NodeRegistry::RegisterCallback<CallFunction::FunctionType>("RandomWanderDirection", [](GameObject* go, CallFunction* caller)
 	{
-		auto cellSize = caller->GetContext<float>("CellSize", 1.0f);
-		auto grid = caller->GetContext<Grid<SquareGridNode>*>("AStarGrid", nullptr);
+		auto cellSize = caller->GetContext<float>(Keys::CellSize, 1.0f);
+		auto grid = caller->GetContext<Grid<SquareGridNode>*>(Keys::AStarGrid, nullptr);
 		if (!grid || cellSize < 0)
 			return false;
 		auto position = go->GetPosition() / cellSize;
@@ -131,73 +214,53 @@ void Animal::CreateBehaviourWander()
 				continue; // Path not traversable, try another random direction
 
 			// Valid direction found
-			caller->SetContext("Direction", direction);
-			caller->SetContext("Speed", ((Animal*)go)->GetSpeed() / 2.0f); // Half speed for "leisurely" wanderings
+			caller->SetContext(Keys::Direction, direction);
+			caller->SetContext(Keys::Speed, ((Animal*)go)->GetSpeed() / 2.0f); // Half speed for "leisurely" wanderings
 			return true;
 		}
 		return false;
-	};
-
-	
-	auto loop = sequence->AddChild<RepeatTime>();
-	loop->SetTime(1.0f); // Repeat child execution for x seconds
-	loop->SetChild<Move>()->GetValuesFromContext = true;
+	});
 
 	// Reset speed to original value
-	sequence->AddChild<CallFunction>()->Function = [](GameObject* go, CallFunction* caller) { caller->SetContext("Speed", ((Animal*)go)->GetSpeed()); return true; };
-
-	sequence->AddChild<Wait>()->SetTime(0.5f);
-}
-
-void Animal::CreateBehaviourCheckFood()
-{
-	auto sequence = m_BehaviourTree->Add<Sequence>();
-
-	sequence->AddChild<Conditional>()->Function = [=](GameObject* go, Conditional*)
+	NodeRegistry::RegisterCallback<CallFunction::FunctionType>("ResetSpeed", [](GameObject* go, CallFunction* caller)
 	{
-		return GetHunger() > GetThirst() && GetHunger() >= 0.5f;
-	};
-
-#ifndef NDEBUG
-	sequence->AddChild<Log>()->Message = "Behaviour - Food";
-#endif
+		caller->SetContext(Keys::Speed, ((Animal*)go)->GetSpeed());
+		return true;
+	});
 
-	vector<string> foodTags = {};
-	if (m_FoodClass == FoodClass::Herbivore || m_FoodClass == FoodClass::Omnivore)
-		foodTags.emplace_back("HerbivoreFood");
-	if (m_FoodClass == FoodClass::Carnivore || m_FoodClass == FoodClass::Omnivore)
+	// Down the danger map, or directly away from the closest predator where it's flat
+	NodeRegistry::RegisterCallback<CallFunction::FunctionType>("FleeDirection", [](GameObject* go, CallFunction* caller)
 	{
-		foodTags.emplace_back("CarnivoreFood");
-		foodTags.emplace_back("PassiveCreature");
-	}
-	
-	auto repeat = sequence->AddChild<Repeat>();
-	repeat->Condition = [](GameObject*, Repeat* caller) { return !caller->ContextExists("RepeatCount") || caller->ContextExists("Path"); };
-	auto repeatSequence = repeat->SetChild<Sequence>();
+		InfluenceMap* danger = InfluenceMap::Find("Danger");
+		Vec2 direction = danger ? danger->GetGradient(go->GetPosition()) * -1.0f : Vec2();
+		if (direction.x == 0.0f && direction.y == 0.0f)
+		{
+			GameObject* predator = PerceptionService::FindNearestNeighbour(go, 250.0f, GameObject::GetTagMask("Predator"));
+			if (!predator)
+				return false;
+			direction = (go->GetPosition() - predator->GetPosition()).Normalized();
+		}
 
-	AddFindClosestNavigatable(repeatSequence, foodTags)->Sight = 10000.0f; // TODO: Change depending on creature?
+		caller->SetContext(Keys::Direction, direction);
+		caller->SetContext(Keys::Speed, ((Animal*)go)->GetSpeed());
+		return true;
+	});
 
 	// Remove last node of path, so navigation is next to target
-	repeatSequence->AddChild<CallFunction>()->Function = [](GameObject*, CallFunction* caller)
+	NodeRegistry::RegisterCallback<CallFunction::FunctionType>("TrimPath", [](GameObject*, CallFunction* caller)
 	{
-		if (!caller->ContextExists("Path"))
+		if (!caller->ContextExists(Keys::Path))
 			return false; // Cause node to return fail
-		auto path = caller->GetContext<vector<AStarCell*>>("Path");
+		auto& path = caller->GetContextRef(Keys::Path);
 		if (!path.empty())
-			path.erase(path.end() - 1);
-		caller->SetContext("Path", path);
+			path.pop_back();
 		return true;
-	};
-
-	// If the timer runs out, recalculate path to food (incase it got deleted or moved)
-	auto limitTime = repeatSequence->AddChild<LimitTime>();
-	limitTime->SetTime(1.5f);
-	limitTime->SetChild<NavigatePath>()->Speed = m_Speed;
+	});
 
-	// Reset thirst
-	repeatSequence->AddChild<CallFunction>()->Function = [=](GameObject* go, CallFunction* caller)
+	/// --- NEEDS --- ///
+	NodeRegistry::RegisterCallback<CallFunction::FunctionType>("Eat", [](GameObject* go, CallFunction* caller)
 	{
-		unsigned int targetID = caller->GetContext("Target", -1);
+		unsigned int targetID = caller->GetContext(Keys::Target, (unsigned int)-1);
 		GameObject* target = GameObject::FromID(targetID);
 		if (!target)
 			return false;
@@ -205,8 +268,12 @@ void Animal::CreateBehaviourCheckFood()
 		Animal* targetAnimal = dynamic_cast<Animal*>(target);
 		if (targetAnimal)
 		{
-			goAnimal->AddHunger(targetAnimal->GetHealth() / -200.0f); // Regain hunger, half the health of target
-			targetAnimal->SetHealth(0); // Destroy target
+			// Target can be eaten by others ticking at the same time, only the first gets anything
+			caller->Defer([goAnimal, targetAnimal]()
+			{
+				goAnimal->AddHunger(targetAnimal->GetHealth() / -200.0f); // Regain hunger, half the health of target
+				targetAnimal->SetHealth(0); // Destroy target
+			});
 
 			return true;
 		}
@@ -214,118 +281,11 @@ void Animal::CreateBehaviourCheckFood()
 			goAnimal->SetHunger(0.0f); // Source of food that is (probably) not alive
 
 		return true;
-	};
-}
-
-void Animal::CreateBehaviourCheckDeath()
-{
-	/* 
-	
-	Doesn't work consistently, might comment out for submission as not enough time to properly implement
-	
-
-	auto condition = m_BehaviourTree->Add<Conditional>();
-	condition->Function = [](GameObject* go, Conditional*) { return ((Animal*)go)->GetHealth() <= 0.0f; };
-
-	auto sequence = condition->SetChild<Sequence>();
-
-#ifndef NDEBUG
-	sequence->AddChild<Log>()->Message = "Behaviour - DEATH";
-#endif
-
-	// sequence->AddChild<SetValue>()->Set("AnimationState", "Death");
-#ifndef NDEBUG
-	sequence->AddChild<Log>()->Message = "Behaviour - DEATH SETVALUE";
-#endif
-// #ifndef NDEBUG
-	sequence->AddChild<Conditional>()->Function = [](GameObject* go, Conditional* conditional) { return rand() % 10 + 1 < 2; }; // 20% chance of true (I think?)
-	auto sound = sequence->AddChild<BT::PlaySound>();
-	sound->Sound = LoadSound("./assets/Sounds/Unacceptable.mp3");
-	SetAudioStreamVolume(sound->Sound.stream, 0.5f);
-	sequence->AddChild<Log>()->Message = "Behaviour - DEATH SOUND";
-	sound->WaitForFinish = true;
-// #endif
-
-	// sequence->AddChild<Wait>()->SetTime(0.25f);
-	sequence->AddChild<CallFunction>()->Function = [](GameObject* go, CallFunction*) { go->Destroy(); return true; };
-
-	*/
-}
-
-void Animal::CreateBehaviourCheckWater()
-{
-	auto sequence = m_BehaviourTree->Add<Sequence>();
-	sequence->AddChild<Conditional>()->Function = [=](GameObject* go, Conditional*)
-	{
-		return GetThirst() > GetHunger() && GetThirst() >= 0.4f;
-	};
-#ifndef NDEBUG
-	sequence->AddChild<Log>()->Message = "Behaviour - Water";
-#endif
-
-	AddFindClosestNavigatable(sequence, { "WaterSource" })->Sight = 10000.0f; // TODO: Change depending on creature?
-
-	// Remove last node of path, so navigation is just outside of water's edge
-	sequence->AddChild<CallFunction>()->Function = [](GameObject*, CallFunction* caller)
-	{
-		if (!caller->ContextExists("Path"))
-			return false; // Cause node to return fail
-		auto path = caller->GetContext<vector<AStarCell*>>("Path");
-		if (!path.empty())
-			path.erase(path.end() - 1);
-		caller->SetContext("Path", path);
-		return true;
-	};
+	});
 
-	sequence->AddChild<NavigatePath>()->Speed = m_Speed;
-
-	// Reset thirst
-	sequence->AddChild<CallFunction>()->Function = [=](GameObject* go, CallFunction*)
+	NodeRegistry::RegisterCallback<CallFunction::FunctionType>("Drink", [](GameObject* go, CallFunction*)
 	{
-		SetThirst(0);
+		((Animal*)go)->SetThirst(0);
 		return true;
-	};
-}
-
-void Animal::CreateBehaviourCheckPredator()
-{
-	auto sequence = m_BehaviourTree->Add<Sequence>();
-
-	AddFindClosestNavigatable(sequence, { "Predator" })->Sight = 250.0f;
-#ifndef NDEBUG
-	sequence->AddChild<Log>()->Message = "Behaviour - Predator";
-	sequence->AddChild<Log>()->Message = "{" + to_string(GetID()) + "} should flee!";
-#endif
-
-	// Calculate random direction
-	sequence->AddChild<CallFunction>()->Function = [](GameObject* go, CallFunction* caller)
-	{
-		auto cellSize = caller->GetContext<float>("CellSize", 1.0f);
-		auto grid = caller->GetContext<Grid<SquareGridNode>*>("AStarGrid", nullptr);
-		auto predatorID = caller->GetContext("Target", (unsigned int)-1);
-		GameObject* predator = GameObject::FromID(predatorID);
-		if (!grid || cellSize < 0 || !predator)
-			return false;
-		auto position = go->GetPosition() / cellSize;
-
-		Vec2 direction = (go->GetPosition() - predator->GetPosition()).Normalized();
-		caller->SetContext("Direction", direction);
-		caller->SetContext("Speed", ((Animal*)go)->GetSpeed());
-
-		return false;
-	};
-
-
-	auto loop = sequence->AddChild<RepeatTime>();
-	loop->SetTime(1.0f); // Repeat child execution for x seconds
-	loop->SetChild<Move>()->GetValuesFromContext = true;
+	});
 }
-
-FindClosestNavigatable* Animal::AddFindClosestNavigatable(Sequence* parent, vector<string> tags)
-{
-	auto findClosest = parent->AddChild<FindClosestNavigatable>();
-	findClosest->TargetTags = tags; // Tag to find
-	findClosest->Sight = 100.0f; // TODO: Sight depends on creature?
-	findClosest->CopyGrid(m_Grid);
-	return findClosest;
-}
\ No newline at end of file
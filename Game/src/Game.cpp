@@ -2,9 +2,18 @@
 #include <thread>
 #include <iostream>
 #include <Game.hpp>
+#include <Framework/Logger.hpp>
+#include <Framework/SpatialHash.hpp>
 #include <Framework/PhysicsWorld.hpp>
+#include <Framework/OcclusionGrid.hpp>
+#include <Framework/StaticGeometry.hpp>
+#include <Framework/Jobs/JobSystem.hpp>
 #include <Framework/GameObjects/AnimatedSprite.hpp>
 
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
+#include <Framework/BehaviourTrees/BehaviourProfiler.hpp>
+#include <Framework/BehaviourTrees/PerceptionService.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeScheduler.hpp>
 #include <Framework/BehaviourTrees/Actions/Wait.hpp>
 #include <Framework/BehaviourTrees/Actions/CanSee.hpp>
 #include <Framework/BehaviourTrees/Actions/FindPath.hpp>
@@ -61,7 +70,14 @@ Game::Game()
 	PhysicsWorldArgs args;
 	args.Gravity = { 0, 0 };
 	args.TimeStep = 1.0f / 100.0f;
+	Logger::Init();
 	PhysicsWorld::Init(args);
+	JobSystem::Init();
+	BehaviourTreeScheduler::Init();
+	BT::PerceptionService::Init();
+
+	// Neighbour queries, cells span a few map tiles
+	SpatialHash::SetCellSize(GridCellSize * 2.0f);
 
 	m_Root = new GameObject("Root");
 
@@ -78,9 +94,20 @@ Game::Game()
 
 Game::~Game()
 {
+	GameObject::FlushDestroyQueue();
 	delete m_Root;
+	delete m_Background;
+	delete m_StaticObjects;
+	BehaviourTreeScheduler::Destroy();
+	BT::PerceptionService::Destroy();
+	for (auto& pair : m_InfluenceMaps)
+		Pathfinding::InfluenceMap::Unregister(pair.first);
+	OcclusionGrid::Destroy();
+	Animal::ClearBehaviourDefinitions();
 	CloseWindow();
+	JobSystem::Destroy();
 	PhysicsWorld::Destroy();
+	Logger::Destroy();
 }
 
 void Game::Run()
@@ -95,16 +122,28 @@ void Game::Run()
 		Update();
 
 		PrePhysicsUpdate();
-		m_Root->PrePhysicsUpdate();
+		GameObject::PrePhysicsUpdateAll(); // Only GameObjects with physics bodies
 
-		PhysicsWorld::Step();
+		PhysicsWorld::Step(GetFrameTime()); // Fixed steps, independent of framerate
 
 		PostPhysicsUpdate();
-		m_Root->PostPhysicsUpdate();
+		GameObject::PostPhysicsUpdateAll();
 
+		// Only draw background tiles that are on screen
+		Vec2 screenMin = GetScreenToWorld2D({ 0, 0 }, m_Camera);
+		Vec2 screenMax = GetScreenToWorld2D({ (float)GetScreenWidth(), (float)GetScreenHeight() }, m_Camera);
+		Rectangle screenBounds = { screenMin.x, screenMin.y, screenMax.x - screenMin.x, screenMax.y - screenMin.y };
+		m_Background->SetCullBounds(screenBounds);
 		m_Background->Draw();
 
-		m_Root->Update();
+		m_Root->Think();  // Parallel, per-GameObject state only
+		m_Root->Update(); // Serial, applies changes to shared state
+
+		UpdateInfluenceMaps();
+		BT::PerceptionService::UpdateNeighbours(); // Parallel, read by behaviour trees instead of querying SpatialHash
+		BehaviourTreeScheduler::Update(GetFrameTime(), screenBounds); // Parallel, off-screen creatures think less often
+		BT::PerceptionService::Update(); // Line of sight queries from this frame's ticks, read next tick
+		BT::BehaviourProfiler::EndFrame();
 		m_Root->Draw();
 
 		// Draw debug physics colliders
@@ -131,6 +170,9 @@ void Game::Run()
 
 		DrawUI();
 		EndDrawing();
+
+		// Remove GameObjects destroyed this frame
+		GameObject::FlushDestroyQueue();
 	}
 }
 
@@ -158,6 +200,18 @@ void Game::Update()
 		cell && cell->Traversable)
 		SpawnRandomCreature(mousePos * GridCellSize + Vec2(GridCellSize / 2.0f, GridCellSize / 2.0f),
 			IsMouseButtonPressed(MOUSE_LEFT_BUTTON) ? 0 : 1);
+
+	// Behaviour profiling
+	if (IsKeyPressed(KEY_F3))
+	{
+		BT::BehaviourProfiler::SetEnabled(!BT::BehaviourProfiler::IsEnabled());
+		BT::BehaviourProfiler::Reset();
+	}
+	if (IsKeyPressed(KEY_F4))
+	{
+		BT::BehaviourProfiler::SaveCSV("BehaviourProfile.csv");
+		BT::BehaviourProfiler::SaveJSON("BehaviourProfile.json");
+	}
 }
 
 void Game::PrePhysicsUpdate() { }
@@ -183,6 +237,10 @@ void Game::DrawUI()
 	DrawTextEx(m_Font, "\tSkeleton - Right mouse button", { 10, 10 + FontSize * 5 }, FontSize, Spacing, RAYWHITE);
 
 	DrawTextEx(m_Font, ("Total Creatures: " + to_string(m_Root->GetChildren().size())).c_str(), { 10, 10 + FontSize * 6 }, FontSize, Spacing, RAYWHITE);
+	DrawTextEx(m_Font, "F3 - Toggle behaviour profiler, F4 - Save profile", { 10, 10 + FontSize * 7 }, FontSize, Spacing, RAYWHITE);
+
+	if (BT::BehaviourProfiler::IsEnabled())
+		BT::BehaviourProfiler::DrawOverlay(m_Font, { 10, 10 + FontSize * 9 }, FontSize * 0.75f);
 }
 
 int main()
@@ -192,27 +250,34 @@ int main()
 	return 0;
 }
 
-GameObject* Game::AddBackgroundTile(unsigned int x, unsigned int y, char c, int spriteIndex)
+void Game::AddBackgroundTile(unsigned int x, unsigned int y, char c, int spriteIndex)
 {
-	auto tileDef = m_Map.GetTileDef(c);
-	Sprite* tile = new Sprite(m_BackgroundSheet);
-
-	tile->SetSize({ (float)GridCellSize, (float)GridCellSize });
+	auto& tileDef = m_Map.GetTileDef(c);
 
 	// Check for valid sprite offset index, if invalid then generate random
 	if (spriteIndex < 0 || spriteIndex >= tileDef.SpritesheetOffsets.size())
 		spriteIndex = rand() % tileDef.SpritesheetOffsets.size();
 
-	tile->SetView(
-		tileDef.SpritesheetOffsets[spriteIndex],
-		BackgroundTileSize
+	Vec2& offset = tileDef.SpritesheetOffsets[spriteIndex];
+	m_Background->AddSprite(
+		m_BackgroundSheet,
+		{ offset.x, offset.y, BackgroundTileSize.x, BackgroundTileSize.y },
+		{ x * GridCellSize + GridCellSize / 2.0f, y * GridCellSize - GridCellSize / 2.0f },
+		{ (float)GridCellSize, (float)GridCellSize }
 	);
+}
 
-	tile->SetPosition({ x * GridCellSize + GridCellSize / 2.0f, y * GridCellSize - GridCellSize / 2.0f });
-	return tile;
+// Creates a static GameObject over a map tile, used for tiles that need tags or collision
+GameObject* Game::AddStaticObject(unsigned int x, unsigned int y)
+{
+	GameObject* go = new GameObject("Tile", m_StaticObjects);
+	go->SetStatic(true);
+	go->SetSize({ (float)GridCellSize, (float)GridCellSize });
+	go->SetPosition({ x * GridCellSize + GridCellSize / 2.0f, y * GridCellSize - GridCellSize / 2.0f });
+	return go;
 }
 
-GameObject* Game::AddBackgroundTileWaterEdge(unsigned int x, unsigned int y)
+void Game::AddBackgroundTileWaterEdge(unsigned int x, unsigned int y)
 {
 	WaterEdge edge = WaterEdge::Top;
 
@@ -251,7 +316,7 @@ GameObject* Game::AddBackgroundTileWaterEdge(unsigned int x, unsigned int y)
 	if (tileDown == 'E' && tileLeft == 'E' && m_Map.GetTileChar(x + 1, y + 1) != 'W')
 		edge = WaterEdge::JoinBottomLeft;
 
-	return AddBackgroundTile(x, y, 'E', (int)edge);
+	AddBackgroundTile(x, y, 'E', (int)edge);
 }
 
 GameObject* Game::SpawnRandomCreature(Vec2 position, int index)
@@ -270,7 +335,7 @@ GameObject* Game::SpawnRandomCreature(Vec2 position, int index)
 	creature->SetView(creatureInfo.SpriteOffset, creatureInfo.SpriteSize);
 	creature->SetPosition(position);
 
-	creature->GeneratePhysicsBody();
+	creature->GeneratePhysicsBody(PhysicsBodyType::Kinematic); // Moved by behaviour trees, only used for sight queries
 
 	creature->SetFoodClass(creatureInfo.FoodSource);
 	FoodClass foodClass = creatureInfo.FoodSource;
@@ -283,18 +348,11 @@ GameObject* Game::SpawnRandomCreature(Vec2 position, int index)
 	m_Creatures.push_back(creature);
 
 	creature->InitBehaviourTree(m_PathfindingGrid.get());
-	creature->GetBehaviourTree()->Root()->SetContext("CellSize", GridCellSize);
+	creature->GetBehaviourTree()->GetBlackboard()->Set(BT::Keys::CellSize, GridCellSize);
 
-#ifndef NDEBUG
-	cout << "Created creature @ " << creature->GetPosition() << " " << (creature->GetPosition() / GridCellSize);
-	switch (foodClass)
-	{
-	default:
-	case FoodClass::Omnivore: cout << " [Omnivore]" << endl; break;
-	case FoodClass::Herbivore: cout << " [Herbivore]" << endl; break;
-	case FoodClass::Carnivore: cout << " [Carnivore]" << endl; break;
-	}
-#endif
+	const char* FoodClassNames[] = { "Herbivore", "Omnivore", "Carnivore" };
+	FRAMEWORK_LOG_DEBUG(creature->GetID(), "Game", "Created %s creature @ (%.0f, %.0f)",
+		FoodClassNames[(int)foodClass], creature->GetPosition().x, creature->GetPosition().y);
 	return creature;
 }
 
@@ -373,6 +431,12 @@ void Game::CreateMap()
 	// Create A* grid
 	m_PathfindingGrid = make_unique<PathfindingGrid>(mapWidth, mapHeight);
 
+	// Barriers block line of sight, tile y is drawn one cell above its row
+	OcclusionGrid::Init({ 0.0f, -GridCellSize }, mapWidth, mapHeight, GridCellSize);
+
+	// Barriers are merged into a single static body after map is read
+	StaticGeometryBuilder barriers({ 0.0f, -GridCellSize }, mapWidth, mapHeight, GridCellSize);
+
 	const unordered_map<char, string> CellTags =
 	{
 		{ 'E', "WaterSource"   },
@@ -380,8 +444,12 @@ void Game::CreateMap()
 		{ 'B', "HerbivoreFood" }
 	};
 
-	m_Background = new GameObject("Background");
-	m_Background->ReserveChildren(mapWidth * mapHeight);
+	m_Background = new StaticSpriteLayer("Background");
+	m_Background->Reserve(mapWidth * mapHeight);
+
+	m_StaticObjects = new GameObject("Static Objects");
+	m_StaticObjects->SetStatic(true);
+
 	for (unsigned int x = 0; x < mapWidth; x++)
 	{
 		for (unsigned int y = 0; y < mapHeight; y++)
@@ -395,56 +463,88 @@ void Game::CreateMap()
 			auto cell = m_PathfindingGrid->GetCell(x, y - 1);
 			cell->Traversable = true;
 
-			// Create tile
-			auto foreground = AddBackgroundTile(x, y, tileChar);
-
 			switch (tileChar)
 			{
-			default: break;
+			default:
+				AddBackgroundTile(x, y, tileChar);
+				break;
 			case 'F':
 			case 'B':
 			case '-':
 			{
-				auto backgroundTile = AddBackgroundTile(x, y, 'G'); // Add grass behind
-				backgroundTile->AddChild(foreground);
-				foreground = backgroundTile;
+				AddBackgroundTile(x, y, 'G'); // Add grass behind
+				AddBackgroundTile(x, y, tileChar);
 
 				if (tileChar == '-')
 				{
 					cell->Traversable = false;
-					foreground->GeneratePhysicsBody(false); // Raycast hittable tiles
+					barriers.SetBlocked(x, y);
+					OcclusionGrid::Set(x, y, true);
 				}
 				else
 					cell->Cost = 3;
-
-				if (CellTags.find(tileChar) != CellTags.end())
-					foreground->AddTag(CellTags.at(tileChar));
 				break;
 			}
 			case 'E':
-			{
-				delete foreground;
-
-				foreground = AddBackgroundTileWaterEdge(x, y);
-				m_Background->AddChild(foreground);
-
-				if (CellTags.find(tileChar) != CellTags.end())
-					foreground->AddTag(CellTags.at(tileChar));
-				continue;
-			}
+				AddBackgroundTileWaterEdge(x, y);
+				break;
 			case 'W':
-			{
 				cell->Traversable = false;
+				AddBackgroundTile(x, y, tileChar);
 				break;
-
-				if (CellTags.find(tileChar) != CellTags.end())
-					foreground->AddTag(CellTags.at(tileChar));
-			}
 			}
 
-			m_Background->AddChild(foreground);
+			if (CellTags.find(tileChar) != CellTags.end())
+				AddStaticObject(x, y)->AddTag(CellTags.at(tileChar));
 		}
 	}
+
+	GameObject* barrierBody = new GameObject("Barriers", m_StaticObjects);
+	barrierBody->SetStatic(true);
+	barriers.Build(barrierBody);
+	OcclusionGrid::AddOccluder(barrierBody->GetID());
+
+	CreateInfluenceMaps();
+}
+
+void Game::CreateInfluenceMaps()
+{
+	unsigned int width = m_PathfindingGrid->GetWidth();
+	unsigned int height = m_PathfindingGrid->GetHeight();
+
+	// Static sources, settled once. Creatures climb these to the nearest tile instead of pathfinding to each.
+	// Slow decay so influence reaches across the map
+	Pathfinding::InfluenceMapArgs staticArgs;
+	staticArgs.Decay = 0.95f;
+	for (const string& tag : { "HerbivoreFood", "WaterSource" })
+	{
+		auto map = make_unique<Pathfinding::InfluenceMap>(width, height, GridCellSize, staticArgs);
+		map->CopyTraversable(m_PathfindingGrid.get());
+		for (GameObject* go : GameObject::GetTag(tag))
+			map->SetSource(go->GetID(), go->GetPosition());
+		map->Settle();
+		Pathfinding::InfluenceMap::Register(tag, map.get());
+		m_InfluenceMaps[tag] = move(map);
+	}
+
+	// Predators move, propagated a step each frame
+	Pathfinding::InfluenceMapArgs dangerArgs;
+	dangerArgs.Decay = 0.7f;
+	dangerArgs.Parallel = true;
+	auto danger = make_unique<Pathfinding::InfluenceMap>(width, height, GridCellSize, dangerArgs);
+	danger->CopyTraversable(m_PathfindingGrid.get());
+	Pathfinding::InfluenceMap::Register("Danger", danger.get());
+	m_InfluenceMaps["Danger"] = move(danger);
+}
+
+void Game::UpdateInfluenceMaps()
+{
+	Pathfinding::InfluenceMap* danger = m_InfluenceMaps["Danger"].get();
+	for (GameObject* go : GameObject::GetTag("Predator"))
+		if (!go->IsDestroyed())
+			danger->SetSource(go->GetID(), go->GetPosition());
+	danger->RemoveStaleSources(); // Destroyed predators
+	danger->Update();
 }
 
 /// CREATURE INFO ///
@@ -1,6 +1,7 @@
 #include <Map.hpp>
-#include <iostream>
 #include <fstream>
+#include <cassert>
+#include <Framework/Logger.hpp>
 
 using namespace std;
 using namespace Framework;
@@ -23,7 +24,7 @@ void Map::Load(string filepath)
 	ifstream file(filepath);
 	if (!file)
 	{
-		cout << "Couldn't open map '" << filepath << "'" << endl;
+		FRAMEWORK_LOG_ERROR(Logger::NoAgent, "Map", "Couldn't open map '%s'", filepath.c_str());
 		return; // Unable to open
 	}
 
@@ -53,7 +54,7 @@ void Map::Load(string filepath)
 	}
 	file.close();
 
-	cout << "Loaded map '" << filepath << "'" << endl;
+	FRAMEWORK_LOG_INFO(Logger::NoAgent, "Map", "Loaded map '%s'", filepath.c_str());
 }
 
 void Map::Unload()
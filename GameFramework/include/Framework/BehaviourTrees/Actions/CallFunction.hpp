@@ -7,7 +7,8 @@ namespace Framework::BT
 	class CallFunction : public Action
 	{
 	public:
-		std::function<bool(GameObject*, CallFunction*)> Function;
+		using FunctionType = std::function<bool(GameObject*, CallFunction*)>;
+		FunctionType Function;
 
 		virtual std::string GetName() override { return "CallFunction"; }
 		virtual BehaviourResult Execute(GameObject* go) override;
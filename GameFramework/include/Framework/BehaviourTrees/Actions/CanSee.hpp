@@ -1,38 +1,33 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <box2d/b2_world_callbacks.h>
-#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+#include <Framework/BehaviourTrees/Coroutine.hpp>
+#include <Framework/BehaviourTrees/PerceptionService.hpp>
 
 namespace Framework::BT
 {
-	class CanSee: public Action
+	struct CanSeeLocals
 	{
-		class CanSeeRaycastCallback : public b2RayCastCallback
-		{
-		public:
-			bool Started, Finished;
-			std::string Tag;
-			GameObject* Found;
-
-			CanSeeRaycastCallback() : Started(false), Finished(false), Found(nullptr), Tag() { }
-
-			float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override;
-		};
+		VisibilityTicket Query;
+	};
 
-		CanSeeRaycastCallback m_Callback;
+	// Submits closest candidates in view to PerceptionService, result is read on the following tick
+	class CanSee: public CoroutineAction<CanSeeLocals>
+	{
+	protected:
+		virtual BehaviourResult Resume(GameObject* go, CoroutineFrame<CanSeeLocals>& co) override;
 
 	public:
 		float SightRange = 100.0f;
 		float FieldOfView = 60.0f;
 		std::string TargetTag = "Player";
 
+		// Closest candidates in field of view tested for line of sight, first visible is found
+		unsigned int MaxCandidates = 4;
+
 		bool GetValuesFromContext = false;
 
 		virtual std::string GetName() override { return "CanSee"; }
-		virtual BehaviourResult Execute(GameObject* go) override;
 		virtual void OnDebugDraw(GameObject* go) override;
-
-		static bool InFieldOfView(GameObject* a, GameObject* b, float fov);
 	};
-}
\ No newline at end of file
+}
@@ -2,25 +2,13 @@
 #include <string>
 #include <vector>
 #include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+#include <Framework/BehaviourTrees/PerceptionService.hpp>
 
 namespace Framework::BT
 {
-	class CanSeeTarget : public Action
+	// Submits target to PerceptionService, result is read on the following tick
+	class CanSeeTarget : public Stateful<Action, VisibilityTicket>
 	{
-		class CanSeeTargetRaycastCallback : public b2RayCastCallback
-		{
-		public:
-			bool CanSee;
-			unsigned int TargetID;
-			bool Started, Finished;
-
-			CanSeeTargetRaycastCallback() : CanSee(false), Started(false), Finished(false), TargetID((unsigned int)-1) { }
-
-			float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override;
-		};
-
-		CanSeeTargetRaycastCallback  m_Callback;
-
 	public:
 		float SightRange = 100.0f;
 		float FieldOfView = 60.0f;
@@ -31,4 +19,4 @@ namespace Framework::BT
 		virtual std::string GetName() override { return "CanSeeTarget"; }
 		virtual BehaviourResult Execute(GameObject* go) override;
 	};
-}
\ No newline at end of file
+}
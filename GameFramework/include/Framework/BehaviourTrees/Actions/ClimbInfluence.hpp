@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+
+namespace Framework::BT
+{
+	// Follows an InfluenceMap uphill to the nearest source, storing the cells walked in Path & the source in Target.
+	// Replaces pathfinding to every candidate when targets are InfluenceMap sources
+	class ClimbInfluence : public Action
+	{
+	public:
+		std::string Map; // Name of InfluenceMap, see InfluenceMap::Register
+		float MinimumInfluence = 0.0f; // Fails when influence at GameObject is below this, source is out of reach
+
+		virtual std::string GetName() override { return "ClimbInfluence"; }
+		virtual BehaviourResult Execute(GameObject* go) override;
+	};
+}
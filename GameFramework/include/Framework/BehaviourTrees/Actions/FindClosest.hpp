@@ -8,7 +8,7 @@ namespace Framework::BT
 	class FindClosest : public Action
 	{
 	public:
-		float Sight; // Radius around GameObject
+		float Sight = 10000.0f; // Radius around GameObject
 		std::string TargetTag = "";
 		bool GetTargetFromContext = false;
 
@@ -1,61 +1,46 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <thread>
-#include <atomic>
-#include <mutex>
 #include <Framework/Pathfinding/PathFindingGrid.hpp>
-#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+#include <Framework/BehaviourTrees/Coroutine.hpp>
 
 using SquareGrid = Framework::Pathfinding::Grid<Framework::Pathfinding::SquareGridNode>;
 
-// #define TRY_MULTITHREADING
-
 namespace Framework::BT
 {
-	class FindClosestNavigatable : public Action
+	struct FindClosestNavigatableLocals
 	{
-		// Pathfinding
-		static SquareGrid* m_Grid;
-		Framework::Pathfinding::AStar* m_AStar;
-		std::vector<Pathfinding::AStarCell*> m_FoundPath;
+		std::vector<unsigned int> Candidates; // IDs within sight, closest first
+		size_t Next = 0;                      // Candidate currently being searched for
+		Pathfinding::AStarCell* Start = nullptr;
+		PathTicket Search;
+	};
 
-		// Find in background thread
-#ifdef TRY_MULTITHREADING
-		std::thread m_FindThread;
-		std::mutex m_FindThreadMutex;
-#endif
-		GameObject* m_FoundClosest;
-		BehaviourResult m_FindThreadResult;
-		std::atomic_bool m_FindThreadFinished, m_FindThreadStarted;
+	// Pathfinds to candidates closest first over multiple updates, first one reachable is stored in Target & Path
+	class FindClosestNavigatable : public CoroutineAction<FindClosestNavigatableLocals>
+	{
+		// Pathfinding, shared by all agents using this node
+		static SquareGrid* m_Grid;
 
-		void ExecuteFinding(Vec2 startPos, std::vector<GameObject*> queryList, float cellSize);
+	protected:
+		virtual BehaviourResult Resume(GameObject* go, CoroutineFrame<FindClosestNavigatableLocals>& co) override;
 
 	public:
 		float Sight; // Radius around GameObject
 		bool GetTargetFromContext;
 		std::vector<std::string> TargetTags; // Tags to search for
+		unsigned int StepsPerUpdate;
 
 		FindClosestNavigatable() :
-			TargetTags(),
-			m_FoundPath(),
 			Sight(1000.0f),
-			m_AStar(nullptr),
-			m_FoundClosest(nullptr),
 			GetTargetFromContext(false),
-			m_FindThreadResult(BehaviourResult::Failure)
-
-#ifdef TRY_MULTITHREADING
-			, m_FindThread(),
-			m_FindThreadMutex(),
-			m_FindThreadStarted(false),
-			m_FindThreadFinished(false)
-#endif
+			TargetTags(),
+			StepsPerUpdate(50)
 		{ }
 
+		// Copies grid used for pathfinding. When not called, grid is read from the AStarGrid key
 		void CopyGrid(SquareGrid* grid);
 
 		virtual std::string GetName() override { return "FindClosestNavigatable"; }
-		virtual BehaviourResult Execute(GameObject* go) override;
 	};
-}
\ No newline at end of file
+}
@@ -10,6 +10,7 @@ namespace Framework::BT
 
 		FindFirst() : Tag(), GetTagFromContext(false) { }
 
+		virtual std::string GetName() override { return "FindFirst"; }
 		BehaviourResult Execute(GameObject* go) override;
 	};
 }
\ No newline at end of file
@@ -2,18 +2,24 @@
 #include <memory>
 #include <Framework/Pathfinding/AStar.hpp>
 #include <Framework/Pathfinding/PathFindingGrid.hpp>
-#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+#include <Framework/BehaviourTrees/Coroutine.hpp>
 
 using SquareGrid = Framework::Pathfinding::Grid<Framework::Pathfinding::SquareGridNode>;
 
 namespace Framework::BT
 {
-	class FindPath : public Action
+	struct FindPathLocals
 	{
-		bool m_Started = false;
+		PathTicket Search;
+	};
+
+	// Pathfinds to Target over multiple updates, storing result in Path
+	class FindPath : public CoroutineAction<FindPathLocals>
+	{
+		SquareGrid* m_Grid = nullptr;
 
-		SquareGrid* m_Grid;
-		Framework::Pathfinding::AStar m_AStar;
+	protected:
+		virtual BehaviourResult Resume(GameObject* go, CoroutineFrame<FindPathLocals>& co) override;
 
 	public:
 		unsigned int StepsPerUpdate = 50;
@@ -21,6 +27,5 @@ namespace Framework::BT
 		void CopyGrid(SquareGrid* grid);
 
 		virtual std::string GetName() override { return "FindPath"; }
-		virtual BehaviourResult Execute(GameObject* go) override;
 	};
 }
\ No newline at end of file
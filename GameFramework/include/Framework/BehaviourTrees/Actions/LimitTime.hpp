@@ -2,14 +2,18 @@
 
 namespace Framework::BT
 {
-	class LimitTime : public Decorator
+	// State is time left for child, negative when not started
+	class LimitTime : public Stateful<Decorator, float>
 	{
-		float m_TimeLeft;
 		float m_MaxTime;
 
+	protected:
+		virtual void InitState(float& timeLeft) override { timeLeft = -1.0f; }
+
 	public:
-		LimitTime() : m_TimeLeft(-1) { SetTime(10.0f); }
+		LimitTime() { SetTime(10.0f); }
 
+		virtual std::string GetName() override { return "LimitTime"; }
 		BehaviourResult Execute(GameObject* go) override;
 
 		// Sets the maximum time the child can execute for, in seconds
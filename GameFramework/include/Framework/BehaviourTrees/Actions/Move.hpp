@@ -11,6 +11,7 @@ namespace Framework::BT
 
 		Move() : Speed(10.0f), Direction(0, 0), GetValuesFromContext(false) { }
 
+		virtual std::string GetName() override { return "Move"; }
 		BehaviourResult Execute(GameObject* go) override;
 	};
 }
\ No newline at end of file
@@ -11,6 +11,7 @@ namespace Framework::BT
 
 		MoveTowards() : TargetID((unsigned int)-1), Speed(10.0f), GetValuesFromContext(true) { }
 
+		virtual std::string GetName() override { return "MoveTowards"; }
 		BehaviourResult Execute(GameObject* go) override;
 	};
 }
\ No newline at end of file
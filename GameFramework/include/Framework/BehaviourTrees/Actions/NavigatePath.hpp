@@ -5,16 +5,15 @@
 
 namespace Framework::BT
 {
+	// Follows the Path key, removing each point once reached
 	class NavigatePath : public Action
 	{
-		float m_GridSize;
-		std::vector<Framework::Pathfinding::AStarCell*> m_Path;
-
 	public:
 		float Speed;
 
-		NavigatePath() : Speed(10.0f), m_GridSize(1.0f), m_Path() { }
+		NavigatePath() : Speed(10.0f) { }
 
+		virtual std::string GetName() override { return "NavigatePath"; }
 		BehaviourResult Execute(GameObject* go) override;
 		void OnDebugDraw(GameObject* go) override;
 	};
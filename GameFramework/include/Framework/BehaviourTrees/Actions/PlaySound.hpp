@@ -1,12 +1,19 @@
 #pragma once
 #include <raylib.h>
-#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+#include <Framework/BehaviourTrees/Coroutine.hpp>
 
 namespace Framework::BT
 {
-	class PlaySound : public Action
+	struct PlaySoundLocals
 	{
-		float m_PlayTime;
+		Timer Playing;
+	};
+
+	// Plays sound, optionally pending until it has finished
+	class PlaySound : public CoroutineAction<PlaySoundLocals>
+	{
+	protected:
+		virtual BehaviourResult Resume(GameObject* go, CoroutineFrame<PlaySoundLocals>& co) override;
 
 	public:
 		Sound Sound;
@@ -15,6 +22,5 @@ namespace Framework::BT
 		PlaySound();
 
 		virtual std::string GetName() { return "PlaySound"; }
-		virtual BehaviourResult Execute(GameObject* go) override;
 	};
 }
\ No newline at end of file
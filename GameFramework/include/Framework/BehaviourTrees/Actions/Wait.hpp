@@ -1,21 +1,29 @@
 #pragma once
-#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+#include <Framework/BehaviourTrees/Coroutine.hpp>
 
 namespace Framework::BT
 {
-	class Wait : public Action
+	struct WaitLocals
+	{
+		Timer Delay;
+	};
+
+	// Succeeds after waiting, tree sleeps until then instead of ticking every frame
+	class Wait : public CoroutineAction<WaitLocals>
 	{
-		float m_TimeLeft;
 		float m_WaitTime;
 
+	protected:
+		virtual BehaviourResult Resume(GameObject* go, CoroutineFrame<WaitLocals>& co) override;
+
 	public:
 		Wait();
 
-		float& GetTimeLeft();
+		float GetTimeLeft();
 		float& GetWaitTime();
 		void SetTime(float time);
 
 		virtual std::string GetName() { return "Wait"; }
-		virtual BehaviourResult Execute(GameObject* go) override;
+		virtual bool IsLongRunning() override { return true; }
 	};
 }
\ No newline at end of file
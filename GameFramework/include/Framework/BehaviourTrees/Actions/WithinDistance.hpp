@@ -16,6 +16,7 @@ namespace Framework::BT
 			GetTargetFromContext(true)
 		{ }
 
+		virtual std::string GetName() override { return "WithinDistance"; }
 		BehaviourResult Execute(GameObject* go) override;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <raylib.h>
+#include <unordered_map>
+#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+
+namespace Framework::BT
+{
+	struct BehaviourNodeStats
+	{
+		unsigned long long Calls = 0;
+		unsigned long long InclusiveNs = 0; // Including time spent in children
+		unsigned long long ExclusiveNs = 0;
+		unsigned long long Results[3] = { 0, 0, 0 }; // Indexed by BehaviourResult
+
+		void Add(const BehaviourNodeStats& other);
+	};
+
+	// Opt-in timing of node execution, aggregated across all agents.
+	// Nodes are reported both per instance, by their path from a registered tree root, and per type.
+	// Recording isn't thread safe, BehaviourTreeScheduler ticks trees serially while profiling
+	class BehaviourProfiler
+	{
+		using Clock = std::chrono::steady_clock;
+
+		struct Sample
+		{
+			BehaviourNode* Node;
+			Clock::time_point Start;
+			unsigned long long ChildNs;
+		};
+
+		struct Row
+		{
+			std::string Path;
+			std::string Type;
+			BehaviourNodeStats Stats;
+		};
+
+		static bool m_Enabled;
+		static unsigned long long m_Frames;
+		static std::vector<Sample> m_Stack;
+		static std::unordered_map<BehaviourNode*, BehaviourNodeStats> m_NodeStats;
+		static std::vector<std::pair<std::string, BehaviourNode*>> m_Trees;
+
+		static void CollectRows(BehaviourNode* node, const std::string& parentPath, std::vector<Row>& output);
+		static std::vector<Row> GetNodeRows();
+		static std::vector<Row> GetTypeRows(const std::vector<Row>& nodeRows);
+
+	public:
+		static bool IsEnabled() { return m_Enabled; }
+		static void SetEnabled(bool enabled);
+
+		// Clears all recorded stats
+		static void Reset();
+
+		// Marks end of a frame, used for per-frame averages
+		static void EndFrame();
+
+		// Around a node's execution, called by BehaviourNode::Tick & CompiledTree
+		static void Begin(BehaviourNode* node);
+		static void End(BehaviourNode* node, BehaviourResult result);
+
+		// Names root of a tree, nodes are reported with a path from here. See BehaviourNode::Label for naming subtrees
+		static void RegisterTree(const std::string& name, BehaviourNode* root);
+		static void UnregisterTree(BehaviourNode* root);
+
+		static std::string ToCSV();
+		static std::string ToJSON();
+		static bool SaveCSV(const std::string& path);
+		static bool SaveJSON(const std::string& path);
+
+		// Lists node types with the most exclusive time
+		static void DrawOverlay(Font font, Vector2 position, float fontSize, unsigned int maxRows = 10);
+	};
+}
@@ -2,27 +2,64 @@
 #include <vector>
 #include <memory>
 #include <cassert>
-#include <unordered_map>
 #include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+#include <Framework/BehaviourTrees/CompiledTree.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeDefinition.hpp>
 
 namespace Framework
 {
+	// Agent's instance of a behaviour tree, nodes are shared through a BehaviourTreeDefinition
 	class BehaviourTree
 	{
-		BT::Selector m_RootNode;
+		std::shared_ptr<BehaviourTreeDefinition> m_Definition;
+
+		BT::Blackboard m_Blackboard;
+		char* m_State; // Per-agent node data, created on first update
+
+		// Running leaf & sleep time, update is skipped while asleep and blackboard is unchanged
+		BT::CompiledTreeProgress m_Progress;
+		unsigned int m_SleepVersion;
+		float m_SleptTime; // Delta time of updates skipped while asleep, passed to nodes on next tick
+
 		GameObject* m_Parent;
 
+		void CreateState();
+		void DestroyState();
+
 	public:
+		// Creates a tree with its own definition
 		BehaviourTree(GameObject* parent);
+		BehaviourTree(GameObject* parent, std::shared_ptr<BehaviourTreeDefinition> definition);
 		~BehaviourTree();
 
+		BehaviourTree(const BehaviourTree&) = delete;
+		BehaviourTree& operator=(const BehaviourTree&) = delete;
+
+		// Clears blackboard & resets node state
 		void Clear();
 		void Update();
+
+		// Actions deferred by nodes are added to deferred for the caller to run, or run straight away when null
+		void Update(float deltaTime, BT::DeferredActions* deferred = nullptr);
+
+		// Creates node state if not created yet. The first update otherwise finalises the shared definition,
+		// so this is called serially before trees tick in parallel
+		void Prepare();
+
+		// Forces next update to walk the tree from the root
+		void Wake();
+		bool IsSleeping();
 		void DebugDraw();
 
 		template<typename T>
-		T* Add() { return m_RootNode.AddChild<T>(); }
+		T* Add() { return m_Definition->Add<T>(); }
+
+		BT::Selector* Root() { return m_Definition->Root(); }
+		BT::Blackboard* GetBlackboard() { return &m_Blackboard; }
+		GameObject* GetParent() { return m_Parent; }
 
-		BT::Selector* Root() { return &m_RootNode; }
+		// Leaf returned Pending on last tick, if any
+		BT::BehaviourNode* GetPendingNode() { return m_Progress.PendingLeaf; }
+		BehaviourTreeDefinition* GetDefinition() { return m_Definition.get(); }
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cassert>
+#include <Framework/BehaviourTrees/CompiledTree.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+
+namespace Framework
+{
+	// Nodes of a behaviour tree, shared by every agent using it.
+	// Agents keep their own blackboard & node state, see BehaviourTree
+	class BehaviourTreeDefinition
+	{
+		// Declared before root node so nodes are destructed before their memory is released
+		Memory::MemoryArena m_Arena;
+		BT::Selector m_RootNode;
+
+		BT::CompiledTree m_CompiledTree;
+
+		// Per-agent state layout
+		size_t m_StateSize;
+		std::vector<BT::BehaviourNode*> m_StatefulNodes;
+
+		bool m_Finalised;
+		std::string m_Name;
+
+		void LayoutState(BT::BehaviourNode* node);
+
+	public:
+		// Name is the root of node paths in BehaviourProfiler output
+		BehaviourTreeDefinition(std::string name = "Tree");
+		~BehaviourTreeDefinition();
+
+		BehaviourTreeDefinition(const BehaviourTreeDefinition&) = delete;
+		BehaviourTreeDefinition& operator=(const BehaviourTreeDefinition&) = delete;
+
+		template<typename T>
+		T* Add()
+		{
+			assert(!m_Finalised); // Nodes can't be added once agents are using definition
+			return m_RootNode.AddChild<T>();
+		}
+
+		BT::Selector* Root() { return &m_RootNode; }
+
+		// Lays out per-agent state & compiles nodes, called when first agent uses definition.
+		// Nodes must not be added or removed afterwards
+		void Finalise();
+		bool IsFinalised() { return m_Finalised; }
+		const std::string& GetName() { return m_Name; }
+
+		size_t GetStateSize() { return m_StateSize; }
+		const BT::CompiledTree& GetCompiledTree() { return m_CompiledTree; }
+
+		// Constructs & destructs node data inside of an agent's state block, which is GetStateSize() bytes
+		void ConstructState(char* state);
+		void DestructState(char* state);
+	};
+}
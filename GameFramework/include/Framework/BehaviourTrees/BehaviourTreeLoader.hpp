@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+#include <Framework/BehaviourTrees/NodeRegistry.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeDefinition.hpp>
+
+namespace Framework::BT
+{
+	// Node parsed from a tree file, before any BehaviourNode is created
+	struct NodeDescription
+	{
+		std::string Type;
+		std::vector<std::pair<std::string, NodeValue>> Properties;
+		std::vector<NodeDescription> Children;
+	};
+
+	// Tree file parsed into node descriptions, along with every file it was read from
+	struct TreeDescription
+	{
+		std::vector<NodeDescription> Nodes; // Added to the definition's root selector
+		std::vector<std::pair<std::string, long>> Sources; // Path & modification time of file & its includes
+	};
+
+	// Reads behaviour trees from text (.bt) & binary (.btb) files. Text format is
+	//	# Comment
+	//	Type Property=Value Property=[Value, Value] { Children }
+	// e.g.
+	//	Sequence Label="Water" {
+	//		Conditional Function=IsThirsty RecheckInterval=0.25
+	//		Include Path="Drink.bt"
+	//	}
+	// Type & property names are those registered with NodeRegistry, callbacks are named with NodeRegistry::RegisterCallback.
+	// Every node also accepts Label, and DebugOnly=true to be left out of release builds.
+	// Include splices the nodes of another file in its place, path is relative to the including file
+	class BehaviourTreeLoader
+	{
+		static bool ParseFile(const std::string& path, TreeDescription& output, std::vector<std::string>& includeStack);
+		static bool Instantiate(const NodeDescription& description, BehaviourNode* parent, const std::string& path);
+
+	public:
+		static bool ParseText(const std::string& path, TreeDescription& output);
+
+		static bool ReadBinary(const std::string& path, TreeDescription& output);
+		static bool WriteBinary(const std::string& path, const TreeDescription& description);
+
+		// False if binary file is missing or any of the files it was built from have changed since
+		static bool IsBinaryCurrent(const std::string& path);
+
+		// Creates nodes under definition's root, which must not be finalised yet
+		static bool Instantiate(const TreeDescription& description, BehaviourTreeDefinition& definition, const std::string& path = "");
+
+		// Loads text file, using binary cache beside it (path + "b") when current & writing one when not.
+		// Errors are logged, returns false if tree could not be fully created
+		static bool Load(const std::string& path, BehaviourTreeDefinition& definition);
+	};
+}
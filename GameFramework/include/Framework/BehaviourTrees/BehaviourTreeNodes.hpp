@@ -1,24 +1,43 @@
 #pragma once
-#include <any>
 #include <vector>
 #include <memory>
 #include <string>
 #include <cassert>
 #include <functional>
-#include <unordered_map>
 #include <Framework/GameObject.hpp>
+#include <Framework/Memory/MemoryArena.hpp>
+#include <Framework/BehaviourTrees/Blackboard.hpp>
 
-namespace Framework { class BehaviourTree; } // Forward declaration for friending
+namespace Framework { class BehaviourTree; class BehaviourTreeDefinition; } // Forward declaration for friending
 
 namespace Framework::BT
 {
 	class Composite;
 	class Decorator;
+	class CompiledTree;
 	class Evaluator;
 	class Conditional;
+	class BehaviourNode;
 
 	enum class BehaviourResult { Success, Failure, Pending };
 
+	// Actions nodes have deferred while their tree ticked, applied once every tree has ticked (see BehaviourNode::Defer)
+	using DeferredActions = std::vector<std::function<void()>>;
+
+	// Agent that nodes are currently executing for, set by BehaviourTree during Update & DebugDraw
+	struct ExecutionContext
+	{
+		Blackboard* Context = nullptr;
+		char* State = nullptr; // Agent's state block, laid out by BehaviourTreeDefinition
+		float DeltaTime = 0.0f; // Time since agent's tree last ticked, can span several frames
+
+		// Set by a pending node that doesn't need executing again until a time, see SleepUntil
+		double WakeTime = 0.0;
+		BehaviourNode* SleepNode = nullptr;
+
+		DeferredActions* Deferred = nullptr; // Set while trees tick in parallel
+	};
+
 	class BehaviourNode
 	{
 		friend Composite;
@@ -26,219 +45,226 @@ namespace Framework::BT
 		friend Evaluator;
 		friend Conditional;
 		friend BehaviourTree;
+		friend CompiledTree;
+		friend BehaviourTreeDefinition;
+
+		static thread_local ExecutionContext s_Execution;
+
+		// Offset of this node's data in each agent's state block
+		unsigned int m_StateOffset;
 
-		enum class ContextDataType { Integer, Decimal, String, Other };
-		struct ContextData
+		// Arena of owning tree, children are allocated here when available
+		Memory::MemoryArena* m_Arena;
+
+		template<typename T>
+		T* CreateChild()
 		{
-			std::any Data;
-			ContextDataType Type;
+#ifndef NDEBUG
+			bool isBehaviourType = std::is_base_of<BT::BehaviourNode, T>::value;
+			assert(isBehaviourType);
+#endif
+			T* child = m_Arena ? m_Arena->New<T>() : new T();
+			BehaviourNode* node = child;
+			node->m_Arena = m_Arena;
+			return child;
+		}
+
+		// Destructs a child created with CreateChild, memory of arena allocated nodes is freed with the arena
+		void DestroyChild(BehaviourNode* child);
+
+	protected:
+		// This node's data for the executing agent, see Stateful
+		void* GetStateData() { return s_Execution.State + m_StateOffset; }
 
-			ContextData() : Type(ContextDataType::Other), Data() { }
-			ContextData(const ContextData& other) : Type(other.Type), Data(other.Data) { }
-			~ContextData() { }
-		};
+		// Called while returning Pending, to tell the tree it can skip updates until time (see GetTime) or the blackboard changes.
+		// Only honoured when this node is the pending leaf of the tree
+		void SleepUntil(double time);
 
-		std::unordered_map<std::string, ContextData>* m_Context;
+		// Destructs & reconstructs state of node & all descendants for the executing agent
+		static void ResetState(BehaviourNode* node);
 
 	public:
-		BehaviourNode() : m_Context() {}
-		BehaviourNode(const BehaviourNode& other) : m_Context(other.m_Context) { }
+		// Names subtree in profiler output, see BehaviourProfiler
+		std::string Label;
+
+		BehaviourNode() : m_StateOffset(0), m_Arena(nullptr), Label() {}
+		BehaviourNode(const BehaviourNode& other) : m_StateOffset(other.m_StateOffset), m_Arena(other.m_Arena), Label(other.Label) { }
 		virtual ~BehaviourNode() = default;
 
 		virtual std::string GetName() { return "Node"; }
 		virtual BehaviourResult Execute(GameObject* go) = 0;
+
+		// Executes node, recording it when BehaviourProfiler is enabled. Parents should call this on children instead of Execute
+		BehaviourResult Tick(GameObject* go);
 		virtual void OnDebugDraw(GameObject*) { }
 
+		// Stays pending for a long time without needing to react each frame, agent can tick less often
+		virtual bool IsLongRunning() { return false; }
+
+		// Direct children, used to walk the tree
+		virtual void GetChildNodes(std::vector<BehaviourNode*>&) { }
+
+		// Per-agent data, nodes are shared between agents so must not modify themselves during execution
+		virtual size_t GetStateSize() { return 0; }
+		virtual size_t GetStateAlignment() { return 1; }
+		virtual void ConstructState(void*) { }
+		virtual void DestructState(void*) { }
+
+		// Use instead of GetFrameTime, agents aren't always ticked every frame
+		static float GetDeltaTime() { return s_Execution.DeltaTime; }
+
+		// Runs action after every tree ticking this frame has finished, or straight away when trees tick serially.
+		// Changes other agents could read while ticking (e.g. moving, changing another GameObject) & calls that
+		// aren't thread safe (e.g. drawing, playing sounds) must be deferred. The agent's own blackboard needn't be
+		static void Defer(std::function<void()> action);
+
 		void ClearContext();
-		void ClearContext(std::string name);
-		bool ContextExists(std::string name);
+		void ClearContext(const std::string& name);
+		bool ContextExists(const std::string& name);
 
 		template<typename T>
-		void SetContext(std::string name, T value)
-		{
-			if (!ContextExists(name))
-				m_Context->emplace(name, ContextData());
+		void SetContext(const std::string& name, T value) { s_Execution.Context->Set(name, std::move(value)); }
 
-			ContextData* data = &m_Context->at(name);
-			data->Type = ContextDataType::Other;
-			data->Data = value;
-		}
+		template<typename T>
+		BlackboardValue<T> GetContext(const std::string& name, const T& defaultValue = BlackboardDefault<T>()) { return s_Execution.Context->Get(name, defaultValue); }
 
-		void SetContext(std::string name, int value);
-		void SetContext(std::string name, long value);
-		void SetContext(std::string name, short value);
-		void SetContext(std::string name, float value);
-		void SetContext(std::string name, double value);
-		void SetContext(std::string name, long long value);
-		void SetContext(std::string name, std::string value);
-		void SetContext(std::string name, unsigned int value);
-		void SetContext(std::string name, unsigned long value);
-		void SetContext(std::string name, unsigned short value);
-		void SetContext(std::string name, unsigned long long value);
+		template<typename T>
+		void ClearContext(const BlackboardKey<T>& key) { s_Execution.Context->Clear(key); }
 
 		template<typename T>
-		T GetContext(std::string name)
-		{
-			if (!ContextExists(name))
-				return T();
-			// Can break something if type is different, but using void* to store data so no way to check for error
-			return std::any_cast<T>(m_Context->at(name).Data);
-		}
+		bool ContextExists(const BlackboardKey<T>& key) { return s_Execution.Context->Has(key); }
 
 		template<typename T>
-		T GetContext(std::string name, T defaultValue)
-		{
-			if (!ContextExists(name))
-				return defaultValue;
-			// Can break something if type is different, but using void* to store data so no way to check for error
-			return std::any_cast<T>(m_Context->at(name).Data);
-		}
+		void SetContext(const BlackboardKey<T>& key, typename BlackboardKey<T>::Value value) { s_Execution.Context->Set(key, std::move(value)); }
 
-		template<>
-		int GetContext(std::string name) { return (int)GetContext<unsigned long long>(name); }
-		template<>
-		int GetContext(std::string name, int defaultValue) { return (int)GetContext<unsigned long long>(name, defaultValue); }
-
-		template<>
-		long GetContext(std::string name) { return (long)GetContext<unsigned long long>(name); }
-		template<>
-		long GetContext(std::string name, long defaultValue) { return (long)GetContext<unsigned long long>(name, defaultValue); }
-
-		template<>
-		short GetContext(std::string name) { return (short)GetContext<unsigned long long>(name); }
-		template<>
-		short GetContext(std::string name, short defaultValue) { return (short)GetContext<unsigned long long>(name, defaultValue); }
-
-		template<>
-		long long GetContext(std::string name) { return (long long)GetContext<unsigned long long>(name); }
-		template<>
-		long long GetContext(std::string name, long long defaultValue) { return (long long)GetContext<unsigned long long>(name, defaultValue); }
-
-		template<>
-		unsigned int GetContext(std::string name) { return (unsigned int)GetContext<unsigned long long>(name); }
-		template<>
-		unsigned int GetContext(std::string name, unsigned int defaultValue) { return (unsigned int)GetContext<unsigned long long>(name, defaultValue); }
-
-		template<>
-		unsigned long GetContext(std::string name) { return (unsigned long)GetContext<unsigned long long>(name); }
-		template<>
-		unsigned long GetContext(std::string name, unsigned long defaultValue) { return (unsigned long)GetContext<unsigned long long>(name, defaultValue); }
-
-		template<>
-		unsigned short GetContext(std::string name) { return (unsigned short)GetContext<unsigned long long>(name); }
-		template<>
-		unsigned short GetContext(std::string name, unsigned short defaultValue) { return (unsigned short)GetContext<unsigned long long>(name, defaultValue); }
-
-		template<>
-		unsigned long long GetContext(std::string name) { return GetContext<unsigned long long>(name, 0); }
-		template<>
-		unsigned long long GetContext(std::string name, unsigned long long defaultValue)
-		{
-			if (!ContextExists(name))
-				return defaultValue;
-			ContextData& data = m_Context->at(name);
-			assert(data.Type == ContextDataType::Integer);
-			return std::any_cast<unsigned long long>(data.Data);
-		}
+		template<typename T>
+		BlackboardValue<T> GetContext(const BlackboardKey<T>& key, const typename BlackboardKey<T>::Value& defaultValue = BlackboardDefault<T>())
+		{ return s_Execution.Context->Get(key, defaultValue); }
 
-		template<>
-		float GetContext(std::string name) { return (float)GetContext<double>(name); }
-		template<>
-		float GetContext(std::string name, float defaultValue) { return (float)GetContext<double>(name, defaultValue); }
+		// Stored value without copying, default constructed if not already set
+		template<typename T>
+		typename BlackboardKey<T>::Storage& GetContextRef(const BlackboardKey<T>& key) { return s_Execution.Context->GetRef(key); }
+	};
+	typedef BehaviourNode Action;
 
-		template<>
-		double GetContext(std::string name) { return GetContext<double>(name, 0); }
-		template<>
-		double GetContext(std::string name, double defaultValue)
-		{
-			if (!ContextExists(name))
-				return defaultValue;
-			ContextData& data = m_Context->at(name);
-			assert(data.Type == ContextDataType::Decimal);
-			return std::any_cast<double>(data.Data);
-		}
+	// Node with runtime data of type TState, stored per agent
+	template<typename TBase, typename TState>
+	class Stateful : public TBase
+	{
+	protected:
+		TState& GetState() { return *(TState*)this->GetStateData(); }
 
-		template<>
-		std::string GetContext(std::string name) { return GetContext(name, ""); }
-		template<>
-		std::string GetContext(std::string name, std::string defaultValue)
-		{
-			if (!ContextExists(name))
-				return defaultValue;
-			ContextData& data = m_Context->at(name);
-			assert(data.Type == ContextDataType::String);
-			return std::any_cast<std::string>(data.Data);
-		}
+		// Applies node parameters to newly created state
+		virtual void InitState(TState&) { }
+
+	public:
+		virtual size_t GetStateSize() override { return sizeof(TState); }
+		virtual size_t GetStateAlignment() override { return alignof(TState); }
+		virtual void ConstructState(void* state) override { InitState(*new (state) TState()); }
+		virtual void DestructState(void* state) override { ((TState*)state)->~TState(); }
 	};
-	typedef BehaviourNode Action;
 
 	// Executes a function and uses the result to execute one of two children
 	class Evaluator : public BehaviourNode
 	{
-		std::unique_ptr<BehaviourNode> m_True;
-		std::unique_ptr<BehaviourNode> m_False;
+		BehaviourNode* m_True = nullptr;
+		BehaviourNode* m_False = nullptr;
 
 		friend BehaviourTree;
 
 	public:
-		std::function<bool(GameObject* go, Evaluator* caller)> Function;
+		using FunctionType = std::function<bool(GameObject* go, Evaluator* caller)>;
+		FunctionType Function;
+
+		~Evaluator();
 
 		template<typename T>
 		T* SetResult(bool comparison)
 		{
-			bool isBehaviourType = std::is_base_of<BT::BehaviourNode, T>::value;
-			assert(isBehaviourType);
-
-			std::unique_ptr<BehaviourNode>* m_Child;
-			if (comparison)
-				m_Child = &m_True;
-			else
-				m_Child = &m_False;
-
-			if (m_Child)
-				m_Child->release();
+			BehaviourNode*& child = comparison ? m_True : m_False;
+			DestroyChild(child);
 
-			m_Child->reset(new T());
-			m_Child->get()->m_Context = m_Context;
-			return (T*)m_Child->get();
+			T* result = CreateChild<T>();
+			child = result;
+			return result;
 		}
 
 		virtual BehaviourResult Execute(GameObject* go) override;
+		virtual void GetChildNodes(std::vector<BehaviourNode*>& children) override;
 		virtual std::string GetName() override { return "Evaluator"; }
 	};
 
-	class Conditional : public BehaviourNode
+	struct ConditionalState
+	{
+		bool Cached = false;
+		bool Result = false;
+		double NextCheckTime = 0.0;
+		unsigned long long WatchedVersion = 0;
+	};
+
+	class Conditional : public Stateful<BehaviourNode, ConditionalState>
 	{
-		std::unique_ptr<BehaviourNode> m_Child;
+		BehaviourNode* m_Child = nullptr;
+		std::vector<unsigned int> m_WatchedSlots;
+
+		friend CompiledTree;
+
+		// Sum of watched key versions, versions only increase so this changes whenever any watched key does
+		unsigned long long GetWatchedVersion();
+
 	public:
-		std::function<bool(GameObject* go, Conditional* caller)> Function;
+		using FunctionType = std::function<bool(GameObject* go, Conditional* caller)>;
+		FunctionType Function;
+
+		// Seconds before Function is evaluated again, used with watched keys to cache the result per agent.
+		// When both are unset Function is evaluated every execution
+		float RecheckInterval = 0.0f;
+
+		~Conditional();
+
+		// Re-evaluates Function when key changes, instead of every execution
+		template<typename T>
+		Conditional* Watch(const BlackboardKey<T>& key)
+		{
+			m_WatchedSlots.emplace_back(key.Slot);
+			return this;
+		}
+
+		// Watches key by name, false if no key has been registered with name
+		bool Watch(const std::string& keyName);
+
+		bool IsEventDriven() { return RecheckInterval > 0.0f || !m_WatchedSlots.empty(); }
+
+		// Result of Function, cached when event driven
+		bool Evaluate(GameObject* go);
+
+		// Time cached result expires for executing agent, 0 if evaluated every execution
+		double GetNextCheckTime();
 
 		template<typename T>
 		T* SetChild()
 		{
-			bool isBehaviourType = std::is_base_of<BT::BehaviourNode, T>::value;
-			assert(isBehaviourType);
+			DestroyChild(m_Child);
 
-			if (m_Child)
-				m_Child.release();
-			m_Child = make_unique<T>();
-			m_Child->m_Context = m_Context;
-			return (T*)m_Child.get();
+			T* child = CreateChild<T>();
+			m_Child = child;
+			return child;
 		}
 
 		virtual BehaviourResult Execute(GameObject* go) override;
+		virtual void GetChildNodes(std::vector<BehaviourNode*>& children) override;
 		virtual std::string GetName() override { return "Conditional"; }
 	};
 
 	class Sequence;
 
-	// Abstract node class with many children behaviours
-	class Composite : public BehaviourNode
+	// Abstract node class with many children behaviours, state is index of pending child
+	class Composite : public Stateful<BehaviourNode, int>
 	{
 		std::vector<BehaviourNode*> m_Children;
 
 	protected:
-		int PendingChildIndex = -1; // TODO: Find a better way of doing this?
+		virtual void InitState(int& pendingChildIndex) override { pendingChildIndex = -1; }
 
 	public:
 		~Composite();
@@ -248,19 +274,14 @@ namespace Framework::BT
 		template<typename T>
 		T* AddChild()
 		{
-#ifndef NDEBUG
-			bool isBehaviourType = std::is_base_of<BT::BehaviourNode, T>::value;
-			assert(isBehaviourType);
-#endif
-
-			m_Children.emplace_back(new T());
-			T* child = (T*)m_Children[m_Children.size() - 1];
-			((BehaviourNode*)child)->m_Context = m_Context;
+			T* child = CreateChild<T>();
+			m_Children.emplace_back(child);
 			return child;
 		}
 
 		virtual void OnDebugDraw(GameObject* go) override;
 		virtual BehaviourResult Execute(GameObject* go) = 0;
+		virtual void GetChildNodes(std::vector<BehaviourNode*>& children) override;
 		virtual std::string GetName() override { return "Composite"; }
 	};
 
@@ -288,6 +309,17 @@ namespace Framework::BT
 		virtual std::string GetName() override { return "Selector"; }
 	};
 
+	// OR node that, while a child is pending, checks the guards of higher priority children and switches to one that passes.
+	// A guard is a child Conditional, or a Conditional as the first child of a child Sequence
+	class ReactiveSelector : public Selector
+	{
+	public:
+		static Conditional* GetGuard(BehaviourNode* child);
+
+		virtual BehaviourResult Execute(GameObject* go) override;
+		virtual std::string GetName() override { return "ReactiveSelector"; }
+	};
+
 	// Random OR node (runs random child behaviours until one succeeds)
 	class RandomSelector : public Composite
 	{
@@ -296,32 +328,68 @@ namespace Framework::BT
 		virtual std::string GetName() override { return "RandomSelector"; }
 	};
 
+	struct UtilitySelectorState
+	{
+		int Pending = -1; // Committed child, first so it's read the same as other composites' state
+		double NextCheckTime = 0.0;
+	};
+
+	// OR node that scores every child in one pass and runs the best, falling back to lower scores on failure.
+	// A pending child stays committed until another outscores it by Hysteresis, scores are re-checked every RecheckInterval
+	class UtilitySelector : public Stateful<Composite, UtilitySelectorState>
+	{
+	public:
+		using ScoreType = std::function<float(GameObject* go, UtilitySelector* caller)>;
+
+		// Score of each child by index, children without one score 0. Children scoring 0 or less aren't run
+		std::vector<ScoreType> Scores;
+		float Hysteresis = 0.1f;
+		float RecheckInterval = 0.25f;
+
+		using Composite::AddChild;
+
+		template<typename T>
+		T* AddChild(ScoreType score)
+		{
+			Scores.resize(GetChildren().size());
+			Scores.emplace_back(std::move(score));
+			return AddChild<T>();
+		}
+
+		// Children past this aren't scored, ranking is done in a stack buffer without allocating
+		static const unsigned int MaxChildren = 16;
+
+		// Fills order, which holds MaxChildren, with indices of children worth running, best first. Returns how many.
+		// Committed child (-1 if none) has Hysteresis added
+		unsigned int Rank(GameObject* go, int committed, int* order);
+
+		virtual BehaviourResult Execute(GameObject* go) override;
+		virtual std::string GetName() override { return "UtilitySelector"; }
+	};
+
 	/// --- DECORATORS --- ///
 
 	// Decorator node, always has one child
 	class Decorator : public BehaviourNode
 	{
-		std::unique_ptr<BehaviourNode> m_Child = nullptr;
+		BehaviourNode* m_Child = nullptr;
 	public:
+		~Decorator();
+
 		BehaviourNode* GetChild();
 
 		template<typename T>
 		T* SetChild()
 		{
-#ifndef NDEBUG
-			bool isBehaviourType = std::is_base_of<BT::BehaviourNode, T>::value;
-			assert(isBehaviourType);
-#endif
+			DestroyChild(m_Child);
 
-			if (m_Child)
-				m_Child.release();
-
-			m_Child.reset(new T());
-			m_Child->m_Context = m_Context;
-			return (T*)m_Child.get();
+			T* child = CreateChild<T>();
+			m_Child = child;
+			return child;
 		}
 
 		virtual BehaviourResult Execute(GameObject* go) = 0;
+		virtual void GetChildNodes(std::vector<BehaviourNode*>& children) override;
 		virtual std::string GetName() override { return "Decorator"; }
 	};
 
@@ -347,7 +415,8 @@ namespace Framework::BT
 	class DynamicLog : public Decorator
 	{
 	public:
-		std::function<std::string(GameObject* go, DynamicLog* caller)> Message;
+		using MessageType = std::function<std::string(GameObject* go, DynamicLog* caller)>;
+		MessageType Message;
 
 		virtual BehaviourResult Execute(GameObject* go) override;
 		virtual std::string GetName() override { return "DynamicLog"; }
@@ -362,54 +431,56 @@ namespace Framework::BT
 	};
 
 	// Repeats execution until condition is false (while loop)
-	class Repeat : public Decorator
+	class Repeat : public Stateful<Decorator, unsigned int>
 	{
-		unsigned int m_Repetitions;
-
 	public:
+		using ConditionType = std::function<bool(GameObject* go, Repeat* caller)>;
+
 		bool SingleFrame; // Whether to repeat over one or many update loops
-		std::function<bool(GameObject* go, Repeat* caller)> Condition;
+		ConditionType Condition;
 
-		Repeat() : SingleFrame(false), Condition(nullptr), m_Repetitions(0) { }
+		Repeat() : SingleFrame(false), Condition(nullptr) { }
 
 		virtual BehaviourResult Execute(GameObject* go) override;
 		virtual std::string GetName() override { return "Repeat"; }
 	};
 
 	// Repeats execution of node for certain amount of time
-	class RepeatTime : public Decorator
+	class RepeatTime : public Stateful<Decorator, float>
 	{
-		float m_TimeLeft, m_MaxTime;
+		float m_MaxTime = 0.0f;
+
+	protected:
+		virtual void InitState(float& timeLeft) override { timeLeft = m_MaxTime; }
 
 	public:
 		void SetTime(float value);
 
+		virtual std::string GetName() override { return "RepeatTime"; }
+		virtual bool IsLongRunning() override { return true; }
 		BehaviourResult Execute(GameObject* go) override;
 	};
 
 	// Repeats execution of child until count is reached
-	class RepeatCount : public Decorator
+	class RepeatCount : public Stateful<Decorator, unsigned int>
 	{
-		unsigned int m_Repetitions;
 	public:
 		bool SingleFrame; // Whether to repeat over one or many update loops
 		unsigned int Repetitions = 1;
 
-		RepeatCount() : SingleFrame(false), Repetitions(1), m_Repetitions(0) { }
+		RepeatCount() : SingleFrame(false), Repetitions(1) { }
 
 		virtual BehaviourResult Execute(GameObject* go) override;
 		virtual std::string GetName() override { return "RepeatCount"; }
 	};
 
 	// Repeats execution of child until failure is returned from execution, then returns success
-	class RepeatUntilFail : public Decorator
+	class RepeatUntilFail : public Stateful<Decorator, unsigned int>
 	{
-		unsigned int m_Repetitions;
-
 	public:
 		bool SingleFrame; // Whether to repeat over one or many update loops
 		
-		RepeatUntilFail() : SingleFrame(false), m_Repetitions(0) { }
+		RepeatUntilFail() : SingleFrame(false) { }
 
 		virtual BehaviourResult Execute(GameObject* go) override;
 		virtual std::string GetName() override { return "RepeatUntilFail"; }
@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <raylib.h>
+#include <unordered_map>
+#include <Framework/BehaviourTrees/BehaviourTree.hpp>
+
+namespace Framework
+{
+	// Overrides distance based tick rate of an agent
+	enum class BehaviourTickPriority : uint8_t
+	{
+		Auto, // Tick rate chosen from distance to view & pending node
+		High, // Every frame
+		Low   // Same as agents far from view
+	};
+
+	struct BehaviourTreeSchedulerArgs
+	{
+		// Frames between ticks for agents inside view, within MidDistance of view, and further away
+		unsigned int NearInterval = 1;
+		unsigned int MidInterval = 2;
+		unsigned int FarInterval = 8;
+		float MidDistance = 500.0f;
+
+		// Frames between ticks while tree is asleep or its pending node is long running (e.g. Wait)
+		unsigned int LongRunningInterval = 4;
+
+		// Most trees ticked in a single frame, 0 for no limit. Deferred trees tick first next frame
+		unsigned int MaxTicksPerFrame = 0;
+
+		// Trees ticked together in each job, 0 ticks every tree on the calling thread
+		unsigned int TreesPerJob = 8;
+	};
+
+	// Ticks behaviour trees at per-agent rates, spreading agents sharing a rate evenly across frames.
+	// Time-based nodes are given the time accumulated since the agent last ticked.
+	// Trees tick in parallel on the job system, actions nodes defer are applied afterwards in agent order
+	class BehaviourTreeScheduler
+	{
+		struct Agent
+		{
+			BehaviourTree* Tree;
+			BehaviourTickPriority Priority;
+			unsigned int Phase; // Offsets which frames the agent ticks on
+			float DeltaTime;    // Time since last tick
+			bool Deferred;      // Due last frame but over budget
+		};
+
+		static BehaviourTreeSchedulerArgs m_Args;
+		struct Tick
+		{
+			BehaviourTree* Tree;
+			float DeltaTime;
+		};
+
+		static std::vector<Agent> m_Agents;
+		static std::unordered_map<BehaviourTree*, size_t> m_AgentIndices;
+
+		// Trees due this frame & actions each deferred, reused across frames
+		static std::vector<Tick> m_Ticks;
+		static std::vector<BT::DeferredActions> m_Deferred;
+
+		static unsigned long long m_Frame;
+		static unsigned int m_NextPhase;
+		static size_t m_Cursor; // First agent checked next frame, rotates so deferred agents aren't starved
+		static unsigned int m_TicksLastFrame;
+
+		static unsigned int GetInterval(const Agent& agent, const Rectangle& view);
+
+	public:
+		static void Init(BehaviourTreeSchedulerArgs args = { });
+		static void Destroy();
+
+		static void Register(BehaviourTree* tree, BehaviourTickPriority priority = BehaviourTickPriority::Auto);
+		static void Unregister(BehaviourTree* tree);
+		static void SetPriority(BehaviourTree* tree, BehaviourTickPriority priority);
+
+		// Ticks agents due this frame, then applies their deferred actions.
+		// Ticks serially while BehaviourProfiler is enabled or the job system isn't running.
+		// View is the visible world area, agents inside it tick most often
+		static void Update(float deltaTime, Rectangle view);
+
+		static size_t GetAgentCount();
+		static unsigned int GetTicksLastFrame();
+	};
+}
@@ -0,0 +1,236 @@
+#pragma once
+#include <new>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <typeindex>
+#include <shared_mutex>
+#include <type_traits>
+
+#pragma warning(push, 0) // Disable warnings
+#include <robin_hood.h>
+#pragma warning(pop) // Restore warnings
+
+namespace Framework::BT
+{
+	// Type a value is stored as. Integers & decimals each share one type so they can be read back at any width
+	template<typename T, typename = void>
+	struct BlackboardStorage { using Type = T; };
+
+	template<typename T>
+	struct BlackboardStorage<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>> { using Type = unsigned long long; };
+
+	template<typename T>
+	struct BlackboardStorage<T, std::enable_if_t<std::is_floating_point<T>::value>> { using Type = double; };
+
+	template<>
+	struct BlackboardStorage<const char*> { using Type = std::string; };
+
+	struct BlackboardSlot
+	{
+		std::string Name;
+		std::type_index Type;
+		size_t Offset;
+		size_t Size;
+
+		void (*Destruct)(void* data);
+	};
+
+	// Global, append-only layout of every blackboard key. Slot offsets never change once assigned.
+	// Thread safe, named keys can be created while behaviour trees tick in parallel
+	class BlackboardRegistry
+	{
+		struct Registry
+		{
+			std::shared_mutex Mutex;
+			std::deque<BlackboardSlot> Slots; // Deque so slots returned by GetSlot stay in place as more are added
+			robin_hood::unordered_map<std::string, unsigned int> Names;
+			size_t LayoutSize = 0;
+		};
+		static Registry& GetRegistry();
+
+		template<typename T>
+		static void Destruct(void* data) { ((T*)data)->~T(); }
+
+		static unsigned int Register(const std::string& name, std::type_index type, size_t size, size_t alignment, void (*destruct)(void*));
+
+	public:
+		// Gets slot for name, creating it if it doesn't exist. T must be the storage type
+		template<typename T>
+		static unsigned int Register(const std::string& name)
+		{ return Register(name, typeid(T), sizeof(T), alignof(T), &Destruct<T>); }
+
+		// Returns -1 if name has no slot
+		static int Find(const std::string& name);
+
+		static const BlackboardSlot& GetSlot(unsigned int slot);
+		static unsigned int GetSlotCount();
+		static size_t GetLayoutSize();
+	};
+
+	// What Blackboard::Get returns. Values stored as their own type are returned by reference, others are converted
+	template<typename T>
+	using BlackboardValue = std::conditional_t<std::is_same<T, typename BlackboardStorage<T>::Type>::value, const T&, T>;
+
+	// Default constructed value, so Get can return a reference when nothing is stored & no default is given
+	template<typename T>
+	const T& BlackboardDefault()
+	{
+		static const T value { };
+		return value;
+	}
+
+	// Name resolved to a typed slot, create once (e.g. when building a tree) and reuse
+	template<typename T>
+	struct BlackboardKey
+	{
+		using Value = T;
+		using Storage = typename BlackboardStorage<T>::Type;
+
+		unsigned int Slot;
+		size_t Offset;
+
+		explicit BlackboardKey(const std::string& name) :
+			Slot(BlackboardRegistry::Register<Storage>(name)),
+			Offset(BlackboardRegistry::GetSlot(Slot).Offset) { }
+	};
+
+	// Per-agent values, stored in a flat buffer laid out by BlackboardRegistry.
+	// Values never move once set, so references from GetRef stay valid until the value is cleared
+	class Blackboard
+	{
+		// Keys registered after values were set get their own block instead of reallocating.
+		// Block holds layout offsets up to End, addressed from Start (aligned down so offsets keep their alignment)
+		struct Block
+		{
+			size_t Start;
+			size_t End;
+			char* Data;
+		};
+
+		char* m_Data;
+		size_t m_Size;
+		std::vector<Block> m_Blocks;
+		size_t m_Capacity; // Layout size covered by m_Data & m_Blocks
+		std::vector<uint8_t> m_Set; // Whether each slot holds a value
+
+		// Incremented whenever a value is set or cleared, per slot & for the whole blackboard
+		std::vector<unsigned int> m_Versions;
+		unsigned int m_Version;
+
+		void Changed(unsigned int slot)
+		{
+			m_Versions[slot]++;
+			m_Version++;
+		}
+
+		// Makes room for keys registered after this blackboard was created, without moving set values
+		void Grow();
+		char* BlockData(size_t offset) const;
+
+		template<typename S>
+		S* Data(size_t offset) const { return (S*)(offset < m_Size ? m_Data + offset : BlockData(offset)); }
+
+	public:
+		Blackboard();
+		~Blackboard();
+
+		Blackboard(const Blackboard&) = delete;
+		Blackboard& operator=(const Blackboard&) = delete;
+
+		bool Has(unsigned int slot) const { return slot < m_Set.size() && m_Set[slot]; }
+
+		unsigned int GetVersion() const { return m_Version; }
+		unsigned int GetVersion(unsigned int slot) const { return slot < m_Versions.size() ? m_Versions[slot] : 0; }
+
+		template<typename T>
+		unsigned int GetVersion(const BlackboardKey<T>& key) const { return GetVersion(key.Slot); }
+
+		template<typename T>
+		bool Has(const BlackboardKey<T>& key) const { return Has(key.Slot); }
+
+		// Reference to stored value, or to defaultValue when not set
+		template<typename T>
+		BlackboardValue<T> Get(const BlackboardKey<T>& key, const typename BlackboardKey<T>::Value& defaultValue = BlackboardDefault<T>()) const
+		{
+			using Storage = typename BlackboardKey<T>::Storage;
+			if constexpr (std::is_same<T, Storage>::value)
+				return Has(key.Slot) ? *Data<Storage>(key.Offset) : defaultValue;
+			else
+				return Has(key.Slot) ? (T)*Data<Storage>(key.Offset) : defaultValue;
+		}
+
+		// Stored value, default constructed if not already set. Counts as a change to the value
+		template<typename T>
+		typename BlackboardKey<T>::Storage& GetRef(const BlackboardKey<T>& key)
+		{
+			using Storage = typename BlackboardKey<T>::Storage;
+			if (key.Slot >= m_Set.size())
+				Grow();
+
+			Storage* data = Data<Storage>(key.Offset);
+			if (!m_Set[key.Slot])
+			{
+				new (data) Storage();
+				m_Set[key.Slot] = 1;
+			}
+			Changed(key.Slot);
+			return *data;
+		}
+
+		template<typename T>
+		void Set(const BlackboardKey<T>& key, typename BlackboardKey<T>::Value value)
+		{
+			using Storage = typename BlackboardKey<T>::Storage;
+			if (key.Slot >= m_Set.size())
+				Grow();
+
+			Storage* data = Data<Storage>(key.Offset);
+			if (m_Set[key.Slot])
+				*data = (Storage)std::move(value);
+			else
+			{
+				new (data) Storage((Storage)std::move(value));
+				m_Set[key.Slot] = 1;
+			}
+			Changed(key.Slot);
+		}
+
+		void Clear(unsigned int slot);
+		void Clear();
+
+		template<typename T>
+		void Clear(const BlackboardKey<T>& key) { Clear(key.Slot); }
+
+		/// --- NAMED ACCESS --- ///
+		// Looks up slot by name on every call, prefer BlackboardKey in frequently executed code
+
+		bool Has(const std::string& name) const;
+		void Clear(const std::string& name);
+
+		template<typename T>
+		void Set(const std::string& name, T value) { Set(BlackboardKey<T>(name), std::move(value)); }
+
+		template<typename T>
+		BlackboardValue<T> Get(const std::string& name, const T& defaultValue = BlackboardDefault<T>()) const
+		{
+			using Storage = typename BlackboardStorage<T>::Type;
+			int slot = BlackboardRegistry::Find(name);
+			if (slot < 0 || !Has((unsigned int)slot))
+				return defaultValue;
+
+			const BlackboardSlot& info = BlackboardRegistry::GetSlot((unsigned int)slot);
+			assert(info.Type == std::type_index(typeid(Storage))); // Value was stored as a different type
+			if (info.Type != std::type_index(typeid(Storage)))
+				return defaultValue;
+			if constexpr (std::is_same<T, Storage>::value)
+				return *Data<Storage>(info.Offset);
+			else
+				return (T)*Data<Storage>(info.Offset);
+		}
+	};
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <Framework/Vec2.hpp>
+#include <Framework/Pathfinding/AStar.hpp>
+#include <Framework/Pathfinding/PathFindingGrid.hpp>
+#include <Framework/BehaviourTrees/Blackboard.hpp>
+
+// Keys read & written by the built-in nodes
+namespace Framework::BT::Keys
+{
+	extern const BlackboardKey<unsigned int> Target;
+	extern const BlackboardKey<unsigned int> Found;
+	extern const BlackboardKey<std::string> TargetTag;
+	extern const BlackboardKey<std::vector<std::string>> TargetTags;
+
+	extern const BlackboardKey<float> Sight;
+	extern const BlackboardKey<float> FieldOfView;
+	extern const BlackboardKey<float> CanSeeSight;
+	extern const BlackboardKey<float> CanSeeFieldOfView;
+
+	extern const BlackboardKey<float> Speed;
+	extern const BlackboardKey<Vec2> Direction;
+
+	extern const BlackboardKey<float> CellSize;
+	extern const BlackboardKey<std::vector<Pathfinding::AStarCell*>> Path;
+	extern const BlackboardKey<Pathfinding::AStar*> AStar;
+	extern const BlackboardKey<Pathfinding::Grid<Pathfinding::SquareGridNode>*> AStarGrid;
+
+	extern const BlackboardKey<unsigned int> RepeatCount;
+}
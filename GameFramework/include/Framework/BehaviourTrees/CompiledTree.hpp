@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+
+namespace Framework::BT
+{
+	// Nodes the compiled tree interprets itself, anything else is executed as an opaque leaf
+	enum class CompiledNodeType : uint8_t { Sequence, Selector, ReactiveSelector, UtilitySelector, Inverse, Succeeder, Conditional, Leaf };
+
+	struct CompiledNode
+	{
+		CompiledNodeType Type;
+		unsigned int End;        // One past last node of this subtree, also index of next sibling
+		unsigned int StateOffset; // Offset of node's data in agent's state block
+		BehaviourNode* Node;     // Source node
+		Conditional* Guard;      // Guard checked by a parent ReactiveSelector while a later sibling is pending
+		bool Resumable;          // Pending leaf can be ticked directly, no ancestor reacts to its result each tick
+	};
+
+	// Agent's progress through a compiled tree, kept between updates
+	struct CompiledTreeProgress
+	{
+		int RunningLeaf = -1;  // Pending leaf that is ticked directly instead of walking from root
+		BehaviourNode* PendingLeaf = nullptr; // Last leaf to return Pending, resumable or not
+		double WakeTime = 0.0; // Tree doesn't need executing until this time, unless blackboard changes
+	};
+
+	// Behaviour tree lowered into a flat, preorder array.
+	// Children directly follow their parent and are walked by hopping from sibling to sibling using End
+	class CompiledTree
+	{
+		std::vector<CompiledNode> m_Nodes;
+
+		struct TickState
+		{
+			char* State;
+			int ResumedLeaf;               // Leaf already ticked this update, its result is passed up instead
+			BehaviourResult ResumedResult;
+			int RunningLeaf;
+			BehaviourNode* PendingLeaf;
+			double WakeTime;
+		};
+
+		void Append(BehaviourNode* node, bool resumable);
+		BehaviourResult Tick(unsigned int index, GameObject* go, TickState& tick) const;
+		BehaviourResult TickNode(unsigned int index, GameObject* go, TickState& tick) const;
+		BehaviourResult TickLeaf(unsigned int index, GameObject* go, TickState& tick) const;
+		BehaviourResult TickComposite(unsigned int index, GameObject* go, TickState& tick) const;
+		BehaviourResult TickUtility(unsigned int index, GameObject* go, TickState& tick) const;
+
+		// Index of composite's nth child
+		unsigned int GetChild(unsigned int index, int child) const;
+
+	public:
+		CompiledTree() : m_Nodes() { }
+
+		void Clear();
+		void Compile(BehaviourNode* root);
+
+		bool IsCompiled() const { return !m_Nodes.empty(); }
+		size_t GetNodeCount() const { return m_Nodes.size(); }
+
+		// State is the agent's state block, composites store the index of their pending child in it.
+		// Nodes must have their state laid out (see BehaviourTreeDefinition) before compiling.
+		// A resumable pending leaf is ticked directly, the root is only walked once it finishes
+		BehaviourResult Execute(GameObject* go, char* state, CompiledTreeProgress& progress) const;
+
+		// Draws the node that is currently pending
+		void DebugDraw(GameObject* go, const char* state) const;
+	};
+}
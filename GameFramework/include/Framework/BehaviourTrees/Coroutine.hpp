@@ -0,0 +1,237 @@
+#pragma once
+#include <vector>
+#include <Framework/Pathfinding/AStar.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <memory>
+#include <utility>
+#include <coroutine>
+#include <type_traits>
+#define FRAMEWORK_BT_COROUTINES 1
+#endif
+
+namespace Framework::BT
+{
+	// Something a coroutine action waits on. Polled by the action each tick rather than resuming the coroutine,
+	// a wake time lets the tree sleep until it could be ready (see BehaviourNode::SleepUntil)
+	class Awaitable
+	{
+	public:
+		virtual ~Awaitable() = default;
+
+		virtual bool IsReady() = 0;
+
+		// Time (see GetTime) this can't be ready before, 0 if unknown
+		virtual double GetWakeTime() { return 0.0; }
+	};
+
+	// Ready once a number of seconds have passed
+	class Timer : public Awaitable
+	{
+		double m_EndTime = 0.0;
+
+	public:
+		Timer() = default;
+		Timer(float seconds);
+
+		float GetTimeLeft();
+
+		virtual bool IsReady() override;
+		virtual double GetWakeTime() override { return m_EndTime; }
+	};
+
+	// A* search stepped a limited number of times each poll, spreading search cost over several frames
+	class PathTicket : public Awaitable
+	{
+		Pathfinding::AStar m_Search;
+		bool m_Started = false;
+
+	public:
+		unsigned int StepsPerPoll = 50;
+
+		PathTicket() = default;
+		PathTicket(Pathfinding::AStarCell* start, Pathfinding::AStarCell* end, unsigned int stepsPerPoll = 50);
+
+		std::vector<Pathfinding::AStarCell*> GetPath();
+		virtual bool IsReady() override;
+	};
+
+	// Per-agent state of a CoroutineAction, locals that must survive across awaits belong in TLocals
+	template<typename TLocals>
+	struct CoroutineFrame
+	{
+		int Line = 0; // Resume point, 0 when not started
+		TLocals Locals = {};
+	};
+
+	// Action written as a stackless coroutine using the BT_COROUTINE macros, works without C++20.
+	// Frame is reset whenever the coroutine finishes or the node's state is reset, so it always restarts cleanly
+	template<typename TLocals>
+	class CoroutineAction : public Stateful<Action, CoroutineFrame<TLocals>>
+	{
+	protected:
+		// Body of the coroutine, see BT_COROUTINE_BEGIN
+		virtual BehaviourResult Resume(GameObject* go, CoroutineFrame<TLocals>& co) = 0;
+
+		// True when ready, otherwise asks tree to sleep until awaitable could be ready
+		bool Poll(Awaitable& awaitable)
+		{
+			if (awaitable.IsReady())
+				return true;
+			double wakeTime = awaitable.GetWakeTime();
+			if (wakeTime > 0.0)
+				this->SleepUntil(wakeTime);
+			return false;
+		}
+
+	public:
+		virtual BehaviourResult Execute(GameObject* go) override
+		{
+			CoroutineFrame<TLocals>& frame = this->GetState();
+			BehaviourResult result = Resume(go, frame);
+			if (result != BehaviourResult::Pending)
+			{
+				this->DestructState(&frame);
+				this->ConstructState(&frame);
+			}
+			return result;
+		}
+	};
+
+#ifdef FRAMEWORK_BT_COROUTINES
+	// C++20 coroutine returned by CoroutineTaskAction::Run, co_return the node's result
+	class BehaviourTask
+	{
+	public:
+		struct promise_type
+		{
+			BehaviourResult Result = BehaviourResult::Failure;
+			Awaitable* Waiting = nullptr;
+			std::unique_ptr<Awaitable> Owned; // Last temporary awaited
+
+			BehaviourTask get_return_object() { return BehaviourTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			void return_value(BehaviourResult result) { Result = result; }
+			void unhandled_exception() { Result = BehaviourResult::Failure; }
+
+			// Suspends on anything not ready, action polls it without resuming.
+			// Temporaries (e.g. co_await Timer(1.0f)) are moved into the promise & live until the next co_await
+			template<typename T>
+			auto await_transform(T&& awaitable)
+			{
+				using Value = std::remove_reference_t<T>;
+				static_assert(std::is_base_of_v<Awaitable, Value>, "Can only co_await an Awaitable");
+
+				struct Awaiter
+				{
+					Value& Awaited;
+					promise_type& Promise;
+
+					bool await_ready() { return Awaited.IsReady(); }
+					void await_suspend(std::coroutine_handle<>) { Promise.Waiting = &Awaited; }
+					Value& await_resume() { Promise.Waiting = nullptr; return Awaited; }
+				};
+
+				if constexpr (std::is_lvalue_reference_v<T>)
+					return Awaiter { awaitable, *this };
+				else
+				{
+					Owned = std::make_unique<Value>(std::move(awaitable));
+					return Awaiter { *static_cast<Value*>(Owned.get()), *this };
+				}
+			}
+		};
+
+		BehaviourTask() = default;
+		BehaviourTask(BehaviourTask&& other) noexcept : m_Handle(other.m_Handle) { other.m_Handle = nullptr; }
+		BehaviourTask& operator=(BehaviourTask&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Destroy();
+				m_Handle = other.m_Handle;
+				other.m_Handle = nullptr;
+			}
+			return *this;
+		}
+		~BehaviourTask() { Destroy(); }
+
+		BehaviourTask(const BehaviourTask&) = delete;
+		BehaviourTask& operator=(const BehaviourTask&) = delete;
+
+		bool IsValid() { return (bool)m_Handle; }
+		bool IsDone() { return m_Handle && m_Handle.done(); }
+		void Resume() { m_Handle.resume(); }
+		promise_type& GetPromise() { return m_Handle.promise(); }
+
+	private:
+		std::coroutine_handle<promise_type> m_Handle = nullptr;
+
+		explicit BehaviourTask(std::coroutine_handle<promise_type> handle) : m_Handle(handle) { }
+
+		void Destroy()
+		{
+			if (m_Handle)
+				m_Handle.destroy();
+			m_Handle = nullptr;
+		}
+	};
+
+	// Action written as a C++20 coroutine that can co_await any Awaitable.
+	// Coroutine is created on first execute & destroyed with the agent's state
+	class CoroutineTaskAction : public Stateful<Action, BehaviourTask>
+	{
+	protected:
+		virtual BehaviourTask Run(GameObject* go) = 0;
+
+	public:
+		virtual BehaviourResult Execute(GameObject* go) override
+		{
+			BehaviourTask& task = GetState();
+			if (!task.IsValid())
+				task = Run(go);
+
+			// Only resume once what it's waiting on is ready
+			Awaitable* waiting = task.GetPromise().Waiting;
+			if (!waiting || waiting->IsReady())
+				task.Resume();
+
+			if (task.IsDone())
+			{
+				BehaviourResult result = task.GetPromise().Result;
+				task = BehaviourTask();
+				return result;
+			}
+
+			waiting = task.GetPromise().Waiting;
+			if (waiting && waiting->GetWakeTime() > 0.0)
+				SleepUntil(waiting->GetWakeTime());
+			return BehaviourResult::Pending;
+		}
+	};
+#endif
+}
+
+// Stackless coroutine macros for CoroutineAction::Resume, e.g.
+//	BT_COROUTINE_BEGIN(co);
+//	co.Locals.Delay = Timer(1.0f);
+//	BT_AWAIT(co, co.Locals.Delay);
+//	BT_COROUTINE_END(co);
+// Function locals don't survive an await or yield, store them in co.Locals.
+// Resume points use __COUNTER__ rather than __LINE__, which isn't constant with MSVC's edit & continue
+#define BT_COROUTINE_BEGIN(co) switch ((co).Line) { case 0:
+
+#define BT_AWAIT(co, awaitable) BT_AWAIT_AT(co, awaitable, __COUNTER__ + 1)
+#define BT_AWAIT_AT(co, awaitable, id) \
+	do { (co).Line = id; [[fallthrough]]; case id: if (!this->Poll(awaitable)) return Framework::BT::BehaviourResult::Pending; } while (0)
+
+// Returns Pending, continues from here next tick
+#define BT_YIELD(co) BT_YIELD_AT(co, __COUNTER__ + 1)
+#define BT_YIELD_AT(co, id) \
+	do { (co).Line = id; return Framework::BT::BehaviourResult::Pending; case id:; } while (0)
+
+#define BT_COROUTINE_RETURN(result) return (result)
+
+#define BT_COROUTINE_END(co) } return Framework::BT::BehaviourResult::Success
@@ -0,0 +1,136 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <Framework/Vec2.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
+
+namespace Framework::BT
+{
+	// Property value of a node in a tree file. Unquoted words are strings, except true & false
+	struct NodeValue
+	{
+		enum class Type : uint8_t { Number, String, Boolean, List };
+
+		Type ValueType = Type::Number;
+		double Number = 0.0; // Also holds booleans as 0 or 1
+		std::string Text;
+		std::vector<NodeValue> Items;
+
+		// False when value is of the wrong type, output is left unchanged
+		bool Read(float& output) const;
+		bool Read(unsigned int& output) const;
+		bool Read(bool& output) const;
+		bool Read(std::string& output) const;
+		bool Read(std::vector<std::string>& output) const;
+		bool Read(Vec2& output) const;
+	};
+
+	// Node types & callbacks that tree files refer to by name, see BehaviourTreeLoader
+	class NodeRegistry
+	{
+	public:
+		// Applies a value to a node of the property's type, false if value is invalid
+		using Setter = std::function<bool(BehaviourNode* node, const NodeValue& value)>;
+
+		struct NodeType
+		{
+			// Creates node as a child of parent, nullptr if parent can't take another child
+			std::function<BehaviourNode*(BehaviourNode* parent)> Create;
+			std::unordered_map<std::string, Setter> Properties;
+		};
+
+		template<typename T>
+		class Builder
+		{
+			NodeType& m_Type;
+
+		public:
+			Builder(NodeType& type) : m_Type(type) { }
+
+			Builder& Property(const std::string& name, std::function<bool(T* node, const NodeValue& value)> setter)
+			{
+				m_Type.Properties[name] = [setter](BehaviourNode* node, const NodeValue& value) { return setter((T*)node, value); };
+				return *this;
+			}
+
+			// Property read straight into a member, see NodeValue::Read
+			template<typename TField>
+			Builder& Field(const std::string& name, TField T::* member)
+			{ return Property(name, [member](T* node, const NodeValue& value) { return value.Read(node->*member); }); }
+
+			// Member function set to the callback registered with the value's name, see RegisterCallback
+			template<typename TFunction>
+			Builder& Callback(const std::string& name, TFunction T::* member)
+			{
+				return Property(name, [member](T* node, const NodeValue& value)
+				{
+					TFunction* callback = value.ValueType == NodeValue::Type::String ? FindCallback<TFunction>(value.Text) : nullptr;
+					if (!callback)
+						return false;
+					node->*member = *callback;
+					return true;
+				});
+			}
+		};
+
+	private:
+		static std::unordered_map<std::string, NodeType> m_Types;
+		static bool m_DefaultsRegistered;
+
+		static NodeType& AddType(const std::string& name);
+
+		template<typename TFunction>
+		static std::unordered_map<std::string, TFunction>& GetCallbacks()
+		{
+			static std::unordered_map<std::string, TFunction> callbacks;
+			return callbacks;
+		}
+
+		// Built-in nodes, registered the first time a type is looked up
+		static void RegisterDefaults();
+
+	public:
+		// Replaces any existing type of the same name
+		template<typename T>
+		static Builder<T> Register(const std::string& name)
+		{
+			NodeType& type = AddType(name);
+			type.Create = [](BehaviourNode* parent) -> BehaviourNode*
+			{
+				if (Composite* composite = dynamic_cast<Composite*>(parent))
+					return composite->AddChild<T>();
+				if (Decorator* decorator = dynamic_cast<Decorator*>(parent))
+					return decorator->GetChild() ? nullptr : decorator->SetChild<T>();
+
+				// Conditional takes one child, Evaluator takes its true then false child
+				std::vector<BehaviourNode*> children;
+				parent->GetChildNodes(children);
+				if (Conditional* conditional = dynamic_cast<Conditional*>(parent))
+					return children.empty() ? conditional->SetChild<T>() : nullptr;
+				if (Evaluator* evaluator = dynamic_cast<Evaluator*>(parent))
+					return children.size() < 2 ? evaluator->SetResult<T>(children.empty()) : nullptr;
+				return nullptr;
+			};
+			return Builder<T>(type);
+		}
+
+		// Returns nullptr if no type has name
+		static NodeType* Find(const std::string& name);
+
+		// Named function for nodes to use instead of a lambda, e.g. RegisterCallback<CallFunction::FunctionType>("Eat", ...).
+		// Callbacks are stored per function type so different nodes can reuse names
+		template<typename TFunction>
+		static void RegisterCallback(const std::string& name, TFunction function) { GetCallbacks<TFunction>()[name] = std::move(function); }
+
+		// Returns nullptr if no callback of this type has name
+		template<typename TFunction>
+		static TFunction* FindCallback(const std::string& name)
+		{
+			auto& callbacks = GetCallbacks<TFunction>();
+			auto it = callbacks.find(name);
+			return it == callbacks.end() ? nullptr : &it->second;
+		}
+	};
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <unordered_map>
+#pragma warning(push, 0) // Disable warnings
+#include <box2d/b2_collision.h>
+#pragma warning(pop) // Restore warnings
+
+#include <Framework/Vec2.hpp>
+#include <Framework/GameObject.hpp>
+#include <Framework/BehaviourTrees/Coroutine.hpp>
+
+class b2Fixture;
+
+namespace Framework::BT
+{
+	struct PerceptionServiceArgs
+	{
+		float CellSize = 64.0f;           // Width & height of broadphase grid cells, grows to fit MaxGridCells
+		unsigned int MaxGridCells = 65536;
+		unsigned int PacketSize = 8;      // Rays from nearby observers traced together against the same candidates
+		unsigned int PacketsPerJob = 4;
+
+		// Fixtures not rasterized into OcclusionGrid also block sight, tested against the physics world
+		bool DynamicOccluders = true;
+
+		// Tagged GameObjects within this distance of each observer are cached every frame, see QueryNeighbours
+		float NeighbourRange = 250.0f;
+		unsigned int ObserversPerJob = 16;
+	};
+
+	// Line of sight from an observer to candidate targets, resolved along with every other query submitted that frame
+	struct VisibilityQuery
+	{
+		unsigned int Observer = (unsigned int)-1; // Observer's own fixtures never block sight
+		Vec2 From;
+		std::vector<std::pair<unsigned int, Vec2>> Targets; // ID & position, in order of preference
+
+		bool Resolved = false;
+		unsigned int Visible = (unsigned int)-1; // First target with nothing else in the way
+	};
+
+	// Ready once PerceptionService has resolved the query, at the end of the frame it was submitted
+	class VisibilityTicket : public Awaitable
+	{
+		std::shared_ptr<VisibilityQuery> m_Query;
+
+	public:
+		VisibilityTicket() = default;
+		VisibilityTicket(std::shared_ptr<VisibilityQuery> query) : m_Query(std::move(query)) { }
+
+		bool IsValid() { return (bool)m_Query; }
+
+		// ID of first visible target, -1 if none or not resolved yet
+		unsigned int GetVisible();
+
+		virtual bool IsReady() override;
+	};
+
+	// Collects line of sight queries from behaviour tree nodes & resolves them together once per frame.
+	// Also caches who is near each observer once per frame, so nodes of the same agent don't repeat spatial queries.
+	// Rays are first traced through OcclusionGrid for static occluders, then the rest of the physics world is read through one broadphase query into a snapshot, bucketed into a grid, then rays are
+	// sorted into packets of nearby rays that share candidate fixtures & traced in parallel on the job system
+	class PerceptionService
+	{
+		struct Entry
+		{
+			b2Fixture* Fixture;
+			b2AABB Bounds;
+			unsigned int ID; // GameObject owning fixture
+		};
+
+		struct Ray
+		{
+			unsigned int Query;
+			unsigned int Observer;
+			unsigned int Target;
+			b2Vec2 From, To;
+			b2AABB Bounds;
+			unsigned int Cell; // Grid cell of From, rays are sorted by this into packets
+		};
+
+		struct Neighbour
+		{
+			GameObject* Object;
+			float DistanceSqr;
+		};
+
+		struct Observer
+		{
+			GameObject* Object;
+			std::vector<Neighbour> Neighbours; // Closest first, excludes observer
+			bool Built = false;                // False until first UpdateNeighbours after being added
+		};
+
+		static PerceptionServiceArgs m_Args;
+		static bool m_Initialised;
+		static std::vector<std::shared_ptr<VisibilityQuery>> m_Queries;
+		static std::mutex m_QueriesMutex;
+
+		// Snapshot of the physics world, rebuilt each update
+		static std::vector<Entry> m_Entries;
+		static std::vector<unsigned int> m_CellStarts; // Entries of cell i are m_CellEntries[m_CellStarts[i], m_CellStarts[i + 1])
+		static std::vector<unsigned int> m_CellEntries;
+		static b2Vec2 m_GridOrigin;
+		static float m_GridCellSize;
+		static int m_GridWidth, m_GridHeight;
+
+		static std::vector<Ray> m_Rays;
+		static std::vector<uint8_t> m_RayVisible;
+		static unsigned int m_RaysLastFrame;
+
+		static std::vector<Observer> m_Observers;
+		static std::unordered_map<GameObject*, size_t> m_ObserverIndices;
+
+		static void BuildSnapshot(const b2AABB& bounds);
+		static void GetCellRange(const b2AABB& bounds, int& minX, int& minY, int& maxX, int& maxY);
+		static void TracePacket(unsigned int start, unsigned int end, std::vector<unsigned int>& candidates);
+
+	public:
+		static void Init(PerceptionServiceArgs args = { });
+		static void Destroy();
+
+		// Queued until next Update, resolved immediately when not initialised. Thread safe
+		static VisibilityTicket Submit(VisibilityQuery query);
+
+		// Resolves every query submitted since last update, call once per frame after behaviour trees have ticked
+		static void Update();
+
+		static unsigned int GetRaysLastFrame();
+
+		// Observers have their neighbours cached each frame, usually every agent with a behaviour tree
+		static void AddObserver(GameObject* go);
+		static void RemoveObserver(GameObject* go);
+
+		// Caches neighbours of every observer in parallel, call once per frame before behaviour trees tick
+		static void UpdateNeighbours();
+
+		// Appends GameObjects with any tag in mask within range of go, closest first & excluding go.
+		// Read from cache when go is an observer & range is within NeighbourRange, otherwise queries SpatialHash
+		static void QueryNeighbours(GameObject* go, float range, TagMask mask, std::vector<GameObject*>& output);
+		static GameObject* FindNearestNeighbour(GameObject* go, float range, TagMask mask);
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <Framework/Vec2.hpp>
+#include <Framework/GameObject.hpp>
+
+namespace Framework::BT
+{
+	// Field of view & sight range of an observer, precomputed so points can be tested without sqrt or trig
+	struct ViewCone
+	{
+		Vec2 Origin;
+		Vec2 Forward;             // Unit length
+		float CosHalfAngle = 1.0f;
+		float RangeSquared = 0.0f;
+
+		ViewCone() = default;
+		ViewCone(Vec2 origin, Vec2 forward, float fovRadians, float range);
+		ViewCone(GameObject* observer, float fovRadians, float range);
+
+		bool Contains(Vec2 point) const;
+
+		// Appends index of every point inside cone to output, points are given as separate x & y arrays.
+		// Tests 4 points at a time with SSE when available
+		void Filter(const float* x, const float* y, unsigned int count, std::vector<unsigned int>& output) const;
+
+		// Candidates inside cone, keeping their order
+		void Filter(const std::vector<GameObject*>& candidates, std::vector<GameObject*>& output) const;
+	};
+}
@@ -1,7 +1,11 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <shared_mutex>
 #include <Framework/Vec2.hpp>
+#include <Framework/PhysicsBody.hpp>
+#include <Framework/Memory/PoolAllocator.hpp>
 
 #pragma warning(push, 0) // Disable warnings
 #include <robin_hood.h>
@@ -10,38 +14,84 @@
 
 namespace Framework
 {
+	// Bitmask of tags, each unique tag is assigned one bit (see GameObject::GetTagMask)
+	typedef uint64_t TagMask;
+	const TagMask AnyTag = ~(TagMask)0;
+
+	class SpatialHash;
+
 	class GameObject
 	{
+		friend SpatialHash;
+
 		static robin_hood::unordered_map<unsigned int, GameObject*> m_IDs;
 		static robin_hood::unordered_map<std::string, std::vector<GameObject*>> m_GlobalTags;
+		static robin_hood::unordered_map<std::string, TagMask> m_TagBits;
+		static std::shared_mutex m_TagBitsMutex;
+
+		// GameObjects waiting to be destroyed at the end of the frame
+		static std::vector<GameObject*> m_DestroyQueue;
+
+		// Every GameObject with a physics body, so syncing with Box2D doesn't walk the scene
+		static std::vector<GameObject*> m_PhysicsObjects;
 
 		static unsigned int GetNextID();
 
 		unsigned int m_ID;
 		std::string m_Name;
 		bool m_ShouldDelete = false;
+		bool m_Destroyed = false; // True once physics body, tags & ID have been released
+		bool m_Static = false; // Static GameObjects, and their children, skip Think, Update & physics syncing
 
 		float m_Rotation;
 		Vec2 m_Size;
 		Vec2 m_Position;
 		bool m_DirtyTransform;
 		std::vector<std::string> m_Tags;
+		TagMask m_TagMask;
+
+		// Spatial hash cell, only valid when m_SpatiallyIndexed
+		uint64_t m_SpatialCell;
+		bool m_SpatiallyIndexed;
 
 		// Physics
 		b2Body* m_PhysicsBody;
+		Vec2 m_InterpolationOffset; // Movement of body in last physics step, see GetRenderPosition
+		size_t m_PhysicsIndex;      // Index in m_PhysicsObjects, only valid with a physics body
 
 		// Heirarchy
 		GameObject* m_Parent;
 		robin_hood::unordered_map<unsigned int, GameObject*> m_Children;
 
+		void MarkForDestroy();
+		void ReleaseResources();
+		void ReleasePhysicsBody();
+		bool IsStaticInHierarchy();
+
+		// Sync transform of physics body, body must exist
+		void PushTransform();
+		void PullTransform();
+		void CollectDestroyed(std::vector<GameObject*>& output);
+		void CollectActive(std::vector<GameObject*>& output);
+
 	public:
 		GameObject(GameObject* parent = nullptr);
 		GameObject(std::string name, GameObject* parent = nullptr);
-		~GameObject();
+		virtual ~GameObject();
+
+		// Pooled allocation, GameObjects of the same size class are packed into shared chunks
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr, size_t size);
 
 		void Draw();
 		void Update();
+
+		// Calls OnThink on this GameObject & all children, spread across job system workers
+		void Think();
+
+		// Queues this GameObject, and all children, for destruction at the end of the frame
 		void Destroy();
+		bool IsDestroyed();
 		void PrePhysicsUpdate();
 		void PostPhysicsUpdate();
 
@@ -50,12 +100,30 @@ namespace Framework
 			float density = 1.0f,
 			float friction = 0.3f
 		);
+		void GeneratePhysicsBody(
+			PhysicsBodyType type,
+			bool sensor = false, // Found by queries & raycasts, never collides
+			float density = 1.0f,
+			float friction = 0.3f
+		);
+		// One body with a fixture per box, e.g. merged static geometry
+		void GeneratePhysicsBody(
+			const std::vector<PhysicsBox>& boxes,
+			PhysicsBodyType type = PhysicsBodyType::Static,
+			bool sensor = false,
+			float density = 1.0f,
+			float friction = 0.3f
+		);
 
 		/// --- VIRTUALS --- ///
 
 		// Called when a drawing a frame to screen
 		virtual void OnDraw() { }
 
+		// Called once per frame, before OnUpdate, possibly on a worker thread.
+		// Only read shared state & write to this GameObject, anything else belongs in OnUpdate
+		virtual void OnThink() { }
+
 		// Called once per frame
 		virtual void OnUpdate() { }
 
@@ -86,6 +154,9 @@ namespace Framework
 		Vec2& GetPosition();
 		void SetPosition(Vec2 position);
 
+		// Position to draw at, movement of dynamic bodies is interpolated between fixed steps (see PhysicsWorld::Step)
+		Vec2 GetRenderPosition();
+
 		Vec2& GetSize();
 		void SetSize(Vec2 size);
 
@@ -95,18 +166,35 @@ namespace Framework
 		std::string& GetName();
 		void SetName(std::string name);
 
+		bool IsStatic();
+		void SetStatic(bool isStatic);
+
 		Vec2 GetForward();
 		b2Body* GetPhysicsBody();
 
 		void AddTag(std::string tag);
 		void RemoveTag(std::string tag);
 		bool HasTag(std::string tag);
+		TagMask GetTagMask();
 
 		static GameObject* FromID(unsigned int id);
 
+		// Destroys all GameObjects queued by Destroy(), call once per frame
+		static void FlushDestroyQueue();
+
+		// Syncs every non-static GameObject with a physics body, before & after stepping physics.
+		// Cost is proportional to number of bodies rather than size of scene
+		static void PrePhysicsUpdateAll();
+		static void PostPhysicsUpdateAll();
+
 		static std::vector<GameObject*> GetAll();
 		static std::vector<GameObject*> GetTag(std::string tag);
 
+		// Gets the bit assigned to a tag, assigning a new one if tag hasn't been seen before. Supports up to 64 unique tags.
+		// Thread safe
+		static TagMask GetTagMask(const std::string& tag);
+		static TagMask GetTagMask(const std::vector<std::string>& tags);
+
 		operator unsigned int() const { return m_ID; }
 		operator std::string() const { return "GameObject[" + std::to_string(m_ID) + "]"; }
 	};
@@ -16,7 +16,7 @@ namespace Framework
 		AnimatedSprite(Texture texture, GameObject* parent = nullptr);
 		AnimatedSprite(std::string texturePath, GameObject* parent = nullptr);
 
-		virtual void OnUpdate() override;
+		virtual void OnThink() override;
 		virtual void OnDraw() override;
 
 		float& GetTimeBetweenFrames();
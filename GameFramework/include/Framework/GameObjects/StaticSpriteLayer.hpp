@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <Framework/GameObject.hpp>
+
+namespace Framework
+{
+	// Compact storage for sprites that never move, such as background tiles.
+	// Drawn in the order they were added, without a GameObject per sprite
+	class StaticSpriteLayer : public GameObject
+	{
+		struct StaticSprite
+		{
+			Rectangle Source;
+			Rectangle Destination;
+			uint16_t TextureIndex;
+		};
+
+		std::vector<Texture> m_Textures;
+		std::vector<StaticSprite> m_Sprites;
+
+		bool m_Culling;
+		Rectangle m_CullBounds;
+
+		uint16_t GetTextureIndex(const Texture& texture);
+
+	public:
+		StaticSpriteLayer(GameObject* parent = nullptr);
+		StaticSpriteLayer(std::string name, GameObject* parent = nullptr);
+
+		// Adds a sprite centred on position
+		void AddSprite(const Texture& texture, Rectangle view, Vec2 position, Vec2 size);
+		void Reserve(unsigned int count);
+		void ClearSprites();
+
+		unsigned int GetSpriteCount();
+
+		// Sprites outside of bounds are skipped when drawing
+		void SetCullBounds(Rectangle bounds);
+		void DisableCulling();
+
+		virtual void OnDraw() override;
+	};
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <Framework/Jobs/WorkStealingQueue.hpp>
+
+namespace Framework
+{
+	class JobSystem
+	{
+		static std::atomic_bool m_Running;
+		static std::atomic_int m_QueuedJobs;
+		static std::vector<std::thread> m_Workers;
+
+		// One queue per worker, index 0 belongs to the thread that called Init (main thread)
+		static std::vector<std::unique_ptr<WorkStealingQueue>> m_Queues;
+
+		static std::mutex m_WakeMutex;
+		static std::condition_variable m_WakeCondition;
+
+		static void WorkerLoop(unsigned int queueIndex);
+		static bool TryExecuteJob(unsigned int queueIndex);
+		static unsigned int GetQueueIndex();
+
+	public:
+		// Starts worker threads, a workerCount of 0 uses one worker per hardware thread (excluding main thread)
+		static void Init(unsigned int workerCount = 0);
+		static void Destroy();
+
+		static bool IsRunning();
+		static unsigned int GetWorkerCount();
+
+		// Queues a job on the calling thread's queue, counter is incremented until the job finishes.
+		// Executes immediately when the job system isn't running
+		static void Execute(std::function<void()> function, JobCounter& counter);
+
+		// Executes queued jobs on the calling thread until counter reaches zero
+		static void Wait(JobCounter& counter);
+
+		// Splits [0, count) into batches of batchSize and runs function(start, end) for each batch in parallel.
+		// Blocks until all batches are complete
+		static void ParallelFor(unsigned int count, unsigned int batchSize, std::function<void(unsigned int start, unsigned int end)> function);
+	};
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+namespace Framework
+{
+	// Tracks completion of a group of jobs
+	struct JobCounter
+	{
+		std::atomic_int Pending = 0;
+
+		bool IsFinished() { return Pending.load() <= 0; }
+	};
+
+	struct Job
+	{
+		std::function<void()> Function;
+		JobCounter* Counter = nullptr;
+	};
+
+	// Double-ended job queue owned by a single worker.
+	// The owner pushes & pops from the back (LIFO, cache friendly), other workers steal from the front (FIFO)
+	class WorkStealingQueue
+	{
+		std::deque<Job> m_Jobs;
+		std::mutex m_Mutex;
+
+	public:
+		void Push(Job job);
+		bool Pop(Job& output);
+		bool Steal(Job& output);
+		bool Empty();
+	};
+}
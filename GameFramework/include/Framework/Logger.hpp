@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+
+namespace Framework
+{
+	enum class LogLevel : uint8_t { Trace, Debug, Info, Warning, Error, None };
+
+	// Messages below this level are compiled out, see FRAMEWORK_LOG
+#ifndef FRAMEWORK_LOG_LEVEL
+	#ifdef NDEBUG
+		#define FRAMEWORK_LOG_LEVEL 2 // Info
+	#else
+		#define FRAMEWORK_LOG_LEVEL 1 // Debug
+	#endif
+#endif
+
+	// Asynchronous logger. Messages are formatted straight into a fixed size ring buffer,
+	// a background thread writes them out so callers never allocate, flush or block.
+	// When the buffer is full new messages are dropped & counted
+	class Logger
+	{
+	public:
+		static const unsigned int NoAgent = (unsigned int)-1;
+
+		struct Record
+		{
+			LogLevel Level;
+			unsigned int Agent; // ID of GameObject the message is about, NoAgent if none
+			double Time;        // Seconds since Init
+			char Node[32];      // Name of node or system writing the message
+			char Message[216];
+		};
+
+	private:
+		struct Cell
+		{
+			std::atomic_size_t Sequence;
+			Record Entry;
+		};
+
+		static Cell* m_Buffer;
+		static size_t m_Mask;
+		static std::atomic_size_t m_EnqueuePosition;
+		static size_t m_DequeuePosition; // Only used by flush thread
+		static std::atomic_size_t m_Dropped;
+		static size_t m_ReportedDropped; // Only used by flush thread
+
+		static std::atomic_bool m_Running;
+		static std::thread m_FlushThread;
+		static std::FILE* m_File;
+		static std::chrono::steady_clock::time_point m_StartTime;
+
+		static void FlushLoop();
+		static size_t Drain();
+		static void WriteRecord(const Record& record, char* buffer, size_t bufferSize, size_t& used);
+
+	public:
+		// Capacity is rounded up to a power of two. Output is written to stdout, and filepath when not empty
+		static void Init(size_t capacity = 4096, std::string filepath = "");
+		static void Destroy();
+
+		static bool IsRunning();
+
+		// Messages dropped since Init because buffer was full
+		static size_t GetDroppedCount();
+
+		// printf style message. Formats synchronously to stdout when not running
+		static void Write(LogLevel level, unsigned int agent, const char* node, const char* format, ...);
+
+		static const char* GetLevelName(LogLevel level);
+	};
+}
+
+#define FRAMEWORK_LOG(level, agent, node, ...) \
+	do { if constexpr ((int)(level) >= FRAMEWORK_LOG_LEVEL) Framework::Logger::Write(level, agent, node, __VA_ARGS__); } while (0)
+
+#define FRAMEWORK_LOG_TRACE(agent, node, ...) FRAMEWORK_LOG(Framework::LogLevel::Trace, agent, node, __VA_ARGS__)
+#define FRAMEWORK_LOG_DEBUG(agent, node, ...) FRAMEWORK_LOG(Framework::LogLevel::Debug, agent, node, __VA_ARGS__)
+#define FRAMEWORK_LOG_INFO(agent, node, ...) FRAMEWORK_LOG(Framework::LogLevel::Info, agent, node, __VA_ARGS__)
+#define FRAMEWORK_LOG_WARNING(agent, node, ...) FRAMEWORK_LOG(Framework::LogLevel::Warning, agent, node, __VA_ARGS__)
+#define FRAMEWORK_LOG_ERROR(agent, node, ...) FRAMEWORK_LOG(Framework::LogLevel::Error, agent, node, __VA_ARGS__)
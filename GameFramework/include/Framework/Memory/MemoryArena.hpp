@@ -0,0 +1,40 @@
+#pragma once
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace Framework::Memory
+{
+	// Bump allocator, memory is only released in bulk when the arena is reset or destroyed.
+	// Destructors of objects created in the arena are not called by the arena.
+	class MemoryArena
+	{
+		struct Block
+		{
+			char* Data;
+			size_t Size;
+			size_t Used;
+		};
+
+		size_t m_BlockSize;
+		std::vector<Block> m_Blocks;
+
+	public:
+		MemoryArena(size_t blockSize = 8192);
+		~MemoryArena();
+
+		MemoryArena(const MemoryArena&) = delete;
+		MemoryArena& operator=(const MemoryArena&) = delete;
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		template<typename T, typename... Args>
+		T* New(Args&&... args) { return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...); }
+
+		// Releases all blocks, any objects still in the arena are invalidated
+		void Reset();
+
+		size_t GetUsedBytes();
+	};
+}
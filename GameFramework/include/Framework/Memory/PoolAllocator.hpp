@@ -0,0 +1,61 @@
+#pragma once
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace Framework::Memory
+{
+	// Fixed-size block allocator. Blocks are carved out of larger chunks and recycled through a free list.
+	// Not thread-safe, allocations are expected to happen on the main thread.
+	class PoolAllocator
+	{
+		size_t m_BlockSize;
+		size_t m_BlocksPerChunk;
+		void* m_FreeList;
+		std::vector<void*> m_Chunks;
+
+		void AllocateChunk();
+
+	public:
+		PoolAllocator(size_t blockSize, size_t blocksPerChunk = 64);
+		~PoolAllocator();
+
+		PoolAllocator(const PoolAllocator&) = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+		void* Allocate();
+		void Free(void* block);
+
+		size_t GetBlockSize();
+
+		// Allocates from a shared pool with a block size of at least 'size' bytes.
+		// Sizes larger than MaxSizeClass are forwarded to the global heap.
+		static void* AllocateSized(size_t size);
+		static void FreeSized(void* block, size_t size);
+
+		static constexpr size_t SizeClassStep = 16;
+		static constexpr size_t MaxSizeClass = 1024;
+	};
+
+	// Typed pool, constructs & destructs objects of type T in pooled memory
+	template<typename T>
+	class ObjectPool
+	{
+		PoolAllocator m_Allocator;
+
+	public:
+		ObjectPool(size_t objectsPerChunk = 64) : m_Allocator(sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T), objectsPerChunk) { }
+
+		template<typename... Args>
+		T* New(Args&&... args) { return new (m_Allocator.Allocate()) T(std::forward<Args>(args)...); }
+
+		void Delete(T* object)
+		{
+			if (!object)
+				return;
+			object->~T();
+			m_Allocator.Free(object);
+		}
+	};
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <robin_hood.h>
+#include <Framework/Vec2.hpp>
+#include <Framework/GameObject.hpp>
+
+namespace Framework
+{
+	// Static occluders rasterized into a packed bit grid, one bit per cell.
+	// Line of sight is traced through cells with a DDA, without touching the physics world or allocating
+	class OcclusionGrid
+	{
+		static Vec2 m_Origin;
+		static float m_CellSize;
+		static unsigned int m_Width, m_Height;
+		static unsigned int m_WordsPerRow;
+		static std::vector<uint64_t> m_Bits;
+
+		// GameObjects rasterized into grid, physics based checks can skip them
+		static robin_hood::unordered_set<unsigned int> m_Occluders;
+
+	public:
+		// Grid covers width x height cells, origin being top-left corner of cell (0, 0)
+		static void Init(Vec2 origin, unsigned int width, unsigned int height, float cellSize);
+		static void Destroy();
+
+		static bool IsInitialised();
+		static float GetCellSize();
+		static unsigned int GetWidth();
+		static unsigned int GetHeight();
+
+		static void Set(unsigned int x, unsigned int y, bool blocked);
+		static bool IsBlocked(int x, int y); // Outside grid is never blocked
+
+		// Marks every cell overlapped by GameObject's bounds as blocked
+		static void AddOccluder(GameObject* go);
+
+		// Registers GameObject whose cells were already set, e.g. owner of merged static geometry
+		static void AddOccluder(unsigned int id);
+		static bool IsOccluder(unsigned int id);
+
+		// True if no blocked cell lies between from & to
+		static bool Trace(Vec2 from, Vec2 to);
+	};
+}
@@ -3,6 +3,10 @@
 #include <vector>
 #include <functional>
 
+#pragma warning(push, 0) // Disable warnings
+#include <robin_hood.h>
+#pragma warning(pop) // Restore warnings
+
 namespace Framework::Pathfinding
 {
 	struct AStarCell
@@ -10,15 +14,18 @@ namespace Framework::Pathfinding
 		float x = 0, y = 0;
 		float Cost = 1.0f;
 		bool Traversable = true;
-		float GScore = 0, HScore = 0, FScore = 0;
-
-		AStarCell* Previous = nullptr;
 		std::vector<AStarCell*> Neighbours;
 
 		AStarCell(float x = 0, float y = 0) : x(x), y(y) { }
 	};
 
-	bool CompareAStarCells(AStarCell* a, AStarCell* b);
+	// Search scores of a cell, kept by each AStar so searches sharing a grid don't overwrite each other
+	struct AStarNode
+	{
+		float GScore = 0, HScore = 0, FScore = 0;
+		AStarCell* Previous = nullptr;
+		bool Open = false, Closed = false;
+	};
 
 	class AStar
 	{
@@ -31,7 +38,7 @@ namespace Framework::Pathfinding
 		float m_LargestFScore = 0.0f, m_SmallestFScore = 0.0f;
 
 		std::vector<AStarCell*> m_OpenList;
-		std::vector<AStarCell*> m_ClosedList;
+		robin_hood::unordered_map<AStarCell*, AStarNode> m_Nodes; // Cells reached by current search
 
 		std::function<float(AStarCell* cell, AStarCell* end)> m_HeuristicFunc;
 
@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <Framework/Vec2.hpp>
+#include <Framework/Pathfinding/PathFindingGrid.hpp>
+
+namespace Framework::Pathfinding
+{
+	struct InfluenceMapArgs
+	{
+		float Decay = 0.8f;            // Multiplier per cell travelled, lower influence reaches less far
+		bool Parallel = false;         // Propagate rows on the job system, worthwhile for large maps
+		unsigned int RowsPerJob = 16;
+	};
+
+	// Influence spread from sources over the traversable cells of a navigation grid.
+	// Each propagation step moves influence one cell, so a settled map holds Strength * Decay^(cost to nearest source).
+	// Sources that move or are removed fade out over following steps
+	class InfluenceMap
+	{
+		struct Source
+		{
+			unsigned int ID;
+			unsigned int Cell;
+			float Strength;
+			bool Touched;  // Set since last RemoveStaleSources
+		};
+
+		InfluenceMapArgs m_Args;
+		unsigned int m_Width, m_Height;
+		float m_CellSize;
+
+		std::vector<float> m_Values, m_Next;
+		std::vector<float> m_Decay;   // Per cell, 0 when not traversable
+		std::vector<float> m_Stamps;  // Strongest source in each cell
+		std::vector<Source> m_Sources;
+		std::unordered_map<unsigned int, size_t> m_SourceIndices;
+		std::unordered_map<unsigned int, unsigned int> m_SourceCells; // Cell to ID of a source in it
+		bool m_StampsDirty = false;
+		bool m_Settled = true;        // Last step changed nothing & sources haven't changed since
+
+		static std::unordered_map<std::string, InfluenceMap*> s_Maps;
+
+		bool GetCell(Vec2 position, unsigned int& x, unsigned int& y);
+		void RebuildStamps();
+		bool PropagateRows(unsigned int start, unsigned int end);
+
+	public:
+		InfluenceMap(unsigned int width, unsigned int height, float cellSize, InfluenceMapArgs args = { });
+
+		unsigned int GetWidth() { return m_Width; }
+		unsigned int GetHeight() { return m_Height; }
+		float GetCellSize() { return m_CellSize; }
+
+		// Influence doesn't pass through untraversable cells, & is reduced further through costly cells
+		void SetTraversable(unsigned int x, unsigned int y, bool traversable, float cost = 1.0f);
+
+		template<typename T>
+		void CopyTraversable(Grid<T>* grid)
+		{
+			for (unsigned int x = 0; x < m_Width && x < grid->GetWidth(); x++)
+				for (unsigned int y = 0; y < m_Height && y < grid->GetHeight(); y++)
+				{
+					AStarCell* cell = grid->GetCell(x, y);
+					SetTraversable(x, y, cell->Traversable, cell->Cost);
+				}
+		}
+
+		// Adds or moves source with ID, usually a GameObject ID
+		void SetSource(unsigned int id, Vec2 position, float strength = 1.0f);
+		void RemoveSource(unsigned int id);
+
+		// Removes sources that haven't been set since last call.
+		// For sources re-set every update, unchanged ones don't restart propagation
+		void RemoveStaleSources();
+		void ClearSources();
+
+		// Runs propagation steps, skipped once map has settled
+		void Update(unsigned int steps = 1);
+
+		// Runs steps until nothing changes, for maps with static sources
+		void Settle(unsigned int maxSteps = 10000);
+
+		float Sample(Vec2 position);
+		float Sample(unsigned int x, unsigned int y);
+
+		// Direction of steepest increase, zero when flat
+		Vec2 GetGradient(Vec2 position);
+
+		// Follows strongest neighbouring cell from position until a local maximum, appending visited cell coordinates to path.
+		// Returns ID of source at end, -1 if there is none
+		unsigned int Climb(Vec2 position, std::vector<Vec2>& path, unsigned int maxSteps = 1000);
+
+		// Named maps, so behaviour tree nodes can find them
+		static void Register(const std::string& name, InfluenceMap* map);
+		static void Unregister(const std::string& name);
+		static InfluenceMap* Find(const std::string& name);
+	};
+}
@@ -71,8 +71,6 @@ namespace Framework::Pathfinding
 				{
 					GridNode* node = (GridNode*)&m_Grid[x][y];
 					node->CalculateNeighbours(this);
-					node->Cell.FScore = node->Cell.GScore = node->Cell.HScore = 0;
-					node->Cell.Previous = nullptr;
 				}
 			}
 		}
@@ -1,7 +1,22 @@
 #pragma once
+#include <cstdint>
 #include <box2d/b2_body.h>
+#include <Framework/Vec2.hpp>
 
 namespace Framework
 {
+	// How a GameObject's physics body is moved, see GameObject::GeneratePhysicsBody
+	enum class PhysicsBodyType : uint8_t
+	{
+		Static,   // Never moves
+		Dynamic,  // Moved by Box2D, position is read back after each step
+		Kinematic // Moved by GameObject, Box2D doesn't solve contacts for it. For bodies used by queries & raycasts
+	};
 
-}
\ No newline at end of file
+	// Box fixture of a physics body, relative to GameObject's position
+	struct PhysicsBox
+	{
+		Vec2 Centre;
+		Vec2 HalfSize;
+	};
+}
@@ -14,6 +14,9 @@ namespace Framework
 		float TimeStep = 1.0f / 100.0f;
 		unsigned int VelocityIterations = 6;
 		unsigned int PositionIterations = 2;
+
+		// Most steps run in one frame when catching up, time past this is dropped so a slow frame can't snowball
+		unsigned int MaxStepsPerFrame = 5;
 	};
 
 	class PhysicsWorld
@@ -21,6 +24,10 @@ namespace Framework
 		static PhysicsWorldArgs m_Args;
 		static b2World* m_World;
 
+		// Simulated time not yet stepped, always less than one TimeStep after Step(deltaTime)
+		static float m_Accumulator;
+		static unsigned int m_StepsLastFrame;
+
 		class PhysicsDebug : public b2Draw
 		{
 			void DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) override;
@@ -37,8 +44,17 @@ namespace Framework
 		static void Init(PhysicsWorldArgs args = { });
 		static void Destroy();
 
+		// Runs a single step of TimeStep
 		static void Step();
 
+		// Runs as many fixed steps as fit in elapsed time, up to MaxStepsPerFrame. Returns number of steps ran
+		static unsigned int Step(float deltaTime);
+
+		// Fraction of a step between last step & current time, for interpolating rendered transforms
+		static float GetInterpolationAlpha();
+		static float GetTimeStep();
+		static unsigned int GetStepsLastFrame();
+
 		static b2World* GetBox2DWorld();
 	};
 }
\ No newline at end of file
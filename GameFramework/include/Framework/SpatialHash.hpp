@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <Framework/Vec2.hpp>
+#include <Framework/GameObject.hpp>
+
+namespace Framework
+{
+	// Uniform grid of tagged GameObjects, used for neighbour queries proportional to local density.
+	// Maintained automatically by GameObject when tags are added & positions change.
+	// Queries can run on several threads at once, as long as nothing is inserted, removed or moved meanwhile
+	class SpatialHash
+	{
+		static float m_CellSize;
+		static robin_hood::unordered_map<uint64_t, std::vector<GameObject*>> m_Cells;
+
+		// Bounds of every cell that has been occupied, in cell coordinates
+		static int m_MinX, m_MinY, m_MaxX, m_MaxY;
+
+		static uint64_t GetKey(int x, int y);
+		static void GetCellCoords(Vec2& position, int& x, int& y);
+		static void RemoveFromCell(GameObject* go);
+		static void AddToCell(GameObject* go, uint64_t key, int x, int y);
+
+	public:
+		// Sets width & height of each cell, re-inserting any indexed GameObjects
+		static void SetCellSize(float size);
+		static float GetCellSize();
+
+		static void Insert(GameObject* go);
+		static void Remove(GameObject* go);
+		static void Update(GameObject* go);
+		static void Clear();
+
+		// Finds all GameObjects with any tag in mask within radius of position
+		static void QueryRadius(Vec2 position, float radius, TagMask mask, std::vector<GameObject*>& output);
+		static std::vector<GameObject*> QueryRadius(Vec2 position, float radius, TagMask mask);
+
+		// Finds up to k GameObjects with any tag in mask closest to position, sorted closest first
+		static void QueryNearest(Vec2 position, unsigned int k, TagMask mask, std::vector<GameObject*>& output,
+								 float maxDistance = std::numeric_limits<float>::max(), GameObject* ignore = nullptr);
+		static std::vector<GameObject*> QueryNearest(Vec2 position, unsigned int k, TagMask mask,
+								 float maxDistance = std::numeric_limits<float>::max(), GameObject* ignore = nullptr);
+	};
+}
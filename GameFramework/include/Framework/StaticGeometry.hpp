@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <Framework/Vec2.hpp>
+#include <Framework/GameObject.hpp>
+#include <Framework/PhysicsBody.hpp>
+
+namespace Framework
+{
+	// Rectangle of cells, in grid coordinates
+	struct StaticRect
+	{
+		unsigned int X, Y;
+		unsigned int Width, Height;
+	};
+
+	// Merges blocked grid cells into few rectangles, attached as fixtures of a single static body.
+	// Keeps broadphase small compared to a body per cell, which every query & raycast has to traverse
+	class StaticGeometryBuilder
+	{
+		Vec2 m_Origin;
+		float m_CellSize;
+		unsigned int m_Width, m_Height;
+		std::vector<bool> m_Blocked;
+
+	public:
+		// Grid covers width x height cells, origin being top-left corner of cell (0, 0)
+		StaticGeometryBuilder(Vec2 origin, unsigned int width, unsigned int height, float cellSize);
+
+		void SetBlocked(unsigned int x, unsigned int y, bool blocked = true);
+		bool IsBlocked(unsigned int x, unsigned int y);
+
+		// Greedily grows each rectangle along its row, then down while whole row below is blocked.
+		// Every blocked cell is covered exactly once
+		std::vector<StaticRect> Merge();
+
+		// Merged rectangles as boxes relative to position
+		std::vector<PhysicsBox> GetBoxes(Vec2 position);
+
+		// Replaces owner's physics body with a static body holding every merged rectangle.
+		// Fixtures report owner's ID. Returns number of rectangles
+		size_t Build(GameObject* owner, float friction = 0.3f);
+	};
+}
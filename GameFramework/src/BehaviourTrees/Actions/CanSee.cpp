@@ -1,4 +1,7 @@
-#include <Framework/PhysicsWorld.hpp>
+#include <algorithm>
+#include <Framework/BehaviourTrees/ViewCone.hpp>
+#include <Framework/BehaviourTrees/PerceptionService.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/CanSee.hpp>
 
 #ifndef NDEBUG
@@ -9,97 +12,58 @@ using namespace std;
 using namespace Framework;
 using namespace Framework::BT;
 
-float CanSee::CanSeeRaycastCallback::ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction)
+BehaviourResult CanSee::Resume(GameObject* go, CoroutineFrame<CanSeeLocals>& co)
 {
-	Found = nullptr;
-	Finished = true;
-	if (Tag.empty())
-		return 0; // Terminate
-
-	GameObject* go = GameObject::FromID((unsigned int)fixture->GetUserData().pointer);
-	if (!go || !go->HasTag(Tag))
-		return 0; // Raycast didn't hit our target, terminate
-
-	// Hit target
-	Found = go;
-	return fraction;
-}
-
-bool CanSee::InFieldOfView(GameObject* a, GameObject* b, float fov)
-{
-	Vec2 forward = a->GetForward();
-	Vec2 targetOffset = (b->GetPosition() - a->GetPosition()).Normalized();
-
-	// test angle of forward and offset against FieldOfView
-	return acos(forward.Dot(targetOffset)) < (fov / 2.0f);
-}
-
-BehaviourResult CanSee::Execute(GameObject* go)
-{
-	if (GetValuesFromContext)
+	BT_COROUTINE_BEGIN(co);
 	{
-		SightRange = GetContext<float>("CanSee_Sight", SightRange);
-		FieldOfView = GetContext<float>("CanSee_FOV", FieldOfView);
-		TargetTag = GetContext<string>("TargetTag", TargetTag);
-	}
-
-	auto pBody = go->GetPhysicsBody();
-	if(!pBody || TargetTag.empty())
-		return BehaviourResult::Failure;
-
-	if (!m_Callback.Started)
-	{
-		// Get closest object
-		float closestDistance = 0.0f;
-		GameObject* closestGO = nullptr;
-
-		vector<GameObject*> queryObjects = GameObject::GetTag(TargetTag);
-		for (int i = (int)queryObjects.size() - 1; i >= 0; i--)
+		float sightRange = SightRange;
+		float fieldOfView = FieldOfView;
+		string targetTag = TargetTag;
+		if (GetValuesFromContext)
 		{
-			if (queryObjects[i]->GetID() == go->GetID())
-				continue;
-			float distance = go->GetPosition().Distance(queryObjects[i]->GetPosition());
-			if (distance > SightRange)
-				continue; // Out of sight range
-
-			// Test if object is in front, within field of view
-			if (!InFieldOfView(go, queryObjects[i], FieldOfView * DEG2RAD))
-				continue;
-
-			if (!closestGO || closestDistance > distance)
-			{
-				closestGO = queryObjects[i];
-				closestDistance = distance;
-				continue;
-			}
+			sightRange = GetContext<float>(Keys::CanSeeSight, SightRange);
+			fieldOfView = GetContext<float>(Keys::CanSeeFieldOfView, FieldOfView);
+			targetTag = GetContext<string>(Keys::TargetTag, TargetTag);
 		}
 
-		if (!closestGO)
-			return BehaviourResult::Failure;
-
-		// Perform raycast
-		Vec2 start = go->GetPosition();
-		Vec2 end = closestGO->GetPosition();
-
-		m_Callback.Found = nullptr;
-		m_Callback.Tag = TargetTag;
-		m_Callback.Started = true;
-		m_Callback.Finished = false;
-		PhysicsWorld::GetBox2DWorld()->RayCast(&m_Callback, start, end);
+		auto pBody = go->GetPhysicsBody();
+		if(!pBody || targetTag.empty())
+			BT_COROUTINE_RETURN(BehaviourResult::Failure);
+
+		// Neighbours within sight range, closest first, that are in front within field of view
+		vector<GameObject*> neighbours, candidates;
+		PerceptionService::QueryNeighbours(go, sightRange, GameObject::GetTagMask(targetTag), neighbours);
+		ViewCone(go, fieldOfView * DEG2RAD, sightRange).Filter(neighbours, candidates);
+		if (candidates.empty())
+			BT_COROUTINE_RETURN(BehaviourResult::Failure);
+
+		// First of the closest candidates with clear line of sight is found
+		size_t count = min(candidates.size(), (size_t)max(MaxCandidates, 1u));
+		VisibilityQuery query;
+		query.Observer = go->GetID();
+		query.From = go->GetPosition();
+		for (size_t i = 0; i < count; i++)
+			query.Targets.emplace_back(candidates[i]->GetID(), candidates[i]->GetPosition());
 
 #ifndef NDEBUG
-		DrawLine((int)start.x, (int)start.y, (int)end.x, (int)end.y, RED);
+		Vec2 start = query.From;
+		Vec2 end = candidates[0]->GetPosition();
+		Defer([start, end]() { DrawLine((int)start.x, (int)start.y, (int)end.x, (int)end.y, RED); });
 #endif
-	}
 
-	if (!m_Callback.Finished)
-		return BehaviourResult::Pending; // Currently raycasting
+		co.Locals.Query = PerceptionService::Submit(move(query));
+	}
+	BT_AWAIT(co, co.Locals.Query);
+	{
+		unsigned int foundID = co.Locals.Query.GetVisible();
+		if (!GameObject::FromID(foundID))
+			foundID = (unsigned int)-1;
 
-	m_Callback.Started = false;
-	m_Callback.Finished = false;
-	SetContext("Target", m_Callback.Found ? m_Callback.Found->GetID() : (unsigned int)-1);
-	SetContext("Found", m_Callback.Found ? m_Callback.Found->GetID() : (unsigned int)-1);
-	return m_Callback.Found == nullptr ? BehaviourResult::Failure : BehaviourResult::Success;
+		SetContext(Keys::Target, foundID);
+		SetContext(Keys::Found, foundID);
+		BT_COROUTINE_RETURN(foundID == (unsigned int)-1 ? BehaviourResult::Failure : BehaviourResult::Success);
+	}
+	BT_COROUTINE_END(co);
 }
 
 void CanSee::OnDebugDraw(GameObject* go)
@@ -116,10 +80,11 @@ void CanSee::OnDebugDraw(GameObject* go)
 	DrawLine((int)currentPos.x, (int)currentPos.y, (int)(currentPos.x + rightFOV.x), (int)(currentPos.y + rightFOV.y), BLUE);
 	DrawLine((int)(currentPos.x + leftFOV.x), (int)(currentPos.y + leftFOV.y), (int)(currentPos.x + rightFOV.x), (int)(currentPos.y + rightFOV.y), BLUE);
 
-	if (m_Callback.Found)
+	GameObject* found = GameObject::FromID(GetContext<unsigned int>(Keys::Found, (unsigned int)-1));
+	if (found)
 	{
 		Vec2 start = go->GetPosition();
-		Vec2 end = m_Callback.Found->GetPosition();
+		Vec2 end = found->GetPosition();
 		DrawLine((int)start.x, (int)start.y, (int)end.x, (int)end.y, GREEN);
 	}
 #endif
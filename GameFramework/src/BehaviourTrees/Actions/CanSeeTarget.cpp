@@ -1,5 +1,5 @@
-#include <Framework/PhysicsWorld.hpp>
-#include <Framework/BehaviourTrees/Actions/CanSee.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
+#include <Framework/BehaviourTrees/ViewCone.hpp>
 #include <Framework/BehaviourTrees/Actions/CanSeeTarget.hpp>
 
 #ifndef NDEBUG
@@ -10,72 +10,63 @@ using namespace std;
 using namespace Framework;
 using namespace Framework::BT;
 
-float CanSeeTarget::CanSeeTargetRaycastCallback::ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction)
+BehaviourResult CanSeeTarget::Execute(GameObject* go)
 {
-	CanSee = false;
-	Finished = true;
-	if (TargetID == (unsigned int)-1)
-		return 0; // No ID set, terminate
-
-	GameObject* go = GameObject::FromID((unsigned int)fixture->GetUserData().pointer);
-	if (go->GetID() != TargetID)
-		return 0; // Raycast didn't hit our target, terminate
+	// Result of query submitted last tick
+	VisibilityTicket& ticket = GetState();
+	if (ticket.IsValid())
+	{
+		if (!ticket.IsReady())
+			return BehaviourResult::Pending;
 
-	// Hit target
-	CanSee = true;
-	return fraction;
-}
+		bool visible = ticket.GetVisible() != (unsigned int)-1;
+		ticket = VisibilityTicket();
+		return visible ? BehaviourResult::Success : BehaviourResult::Failure;
+	}
 
-BehaviourResult CanSeeTarget::Execute(GameObject* go)
-{
+	float sightRange = SightRange;
+	float fieldOfView = FieldOfView;
+	unsigned int targetID = TargetID;
 	if (GetTargetFromContext)
 	{
-		SightRange = GetContext<float>("Sight", 100.0f);
-		FieldOfView = GetContext<float>("FieldOfView", 60.0f);
-		TargetID = GetContext<unsigned int>("Found", (unsigned int)-1);
+		sightRange = GetContext<float>(Keys::Sight, 100.0f);
+		fieldOfView = GetContext<float>(Keys::FieldOfView, 60.0f);
+		targetID = GetContext<unsigned int>(Keys::Found, (unsigned int)-1);
 	}
 
 	auto pBody = go->GetPhysicsBody();
-	if (!pBody || TargetID == (unsigned int)-1 || go->GetID() == TargetID)
+	GameObject* target = GameObject::FromID(targetID);
+	if (!pBody || !target || go->GetID() == targetID)
 		return BehaviourResult::Failure;
 
-	if (!m_Callback.Started)
-	{
-		GameObject* target = GameObject::FromID(TargetID);
-		float fovRads = FieldOfView * (PI / 180.0f);
+	float fovRads = fieldOfView * (PI / 180.0f);
 
-		// Perform raycast
-		Vec2 start = go->GetPosition();
-		Vec2 end = target->GetPosition();
+	Vec2 start = go->GetPosition();
+	Vec2 end = target->GetPosition();
 
 #ifndef NDEBUG
-		// Draw viewcone
-		Vec2 endFOV = go->GetForward() * SightRange;
-		endFOV.Rotate(fovRads / 2.0f);
+	// Draw viewcone
+	Vec2 endFOV = go->GetForward() * sightRange;
+	endFOV.Rotate(fovRads / 2.0f);
+	Defer([start, endFOV]()
+	{
 		DrawLine((int)-start.x, (int)start.y, (int)-(start.x + endFOV.x), (int)(start.y + endFOV.y), BLUE);
 		DrawLine((int)-start.x, (int)start.y, (int)-(start.x - endFOV.x), (int)(start.y + endFOV.y), BLUE);
 		DrawLine((int)-(start.x - endFOV.x), (int)(start.y + endFOV.y), (int)-(start.x + endFOV.x), (int)(start.y + endFOV.y), BLUE);
+	});
 #endif
 
-		if (!CanSee::InFieldOfView(go, target, fovRads) ||
-			start.Distance(end) > SightRange)
-			return BehaviourResult::Failure;
-
-		m_Callback.Started = true;
-		m_Callback.CanSee = false;
-		m_Callback.Finished = false;
-		m_Callback.TargetID = TargetID;
-		PhysicsWorld::GetBox2DWorld()->RayCast(&m_Callback, start, end);
+	if (!ViewCone(start, go->GetForward(), fovRads, sightRange).Contains(end))
+		return BehaviourResult::Failure;
 
 #ifndef NDEBUG
-		DrawLine((int)-start.x, (int)start.y, (int)-end.x, (int)end.y, RED);
+	Defer([start, end]() { DrawLine((int)-start.x, (int)start.y, (int)-end.x, (int)end.y, RED); });
 #endif
-	}
-
-	if (!m_Callback.Finished)
-		return BehaviourResult::Pending; // Currently raycasting
 
-	m_Callback.Started = false;
-	m_Callback.Finished = false;
-	return m_Callback.CanSee ? BehaviourResult::Success : BehaviourResult::Failure;
-}
\ No newline at end of file
+	VisibilityQuery query;
+	query.Observer = go->GetID();
+	query.From = start;
+	query.Targets.emplace_back(targetID, end);
+	ticket = PerceptionService::Submit(move(query));
+	return BehaviourResult::Pending;
+}
@@ -0,0 +1,37 @@
+#include <Framework/Pathfinding/InfluenceMap.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
+#include <Framework/BehaviourTrees/Actions/ClimbInfluence.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+using namespace Framework::Pathfinding;
+
+BehaviourResult ClimbInfluence::Execute(GameObject* go)
+{
+	InfluenceMap* map = InfluenceMap::Find(Map);
+	auto grid = GetContext<Grid<SquareGridNode>*>(Keys::AStarGrid, nullptr);
+	if (!map || !grid)
+		return BehaviourResult::Failure;
+
+	Vec2 position = go->GetPosition();
+	float influence = map->Sample(position);
+	if (influence <= 0.0f || influence < MinimumInfluence)
+		return BehaviourResult::Failure;
+
+	// Settled map has no local maximum other than sources, so climbing walks a shortest path
+	vector<Vec2> cells;
+	unsigned int sourceID = map->Climb(position, cells);
+	if (!GameObject::FromID(sourceID))
+		return BehaviourResult::Failure;
+
+	vector<Pathfinding::AStarCell*> path;
+	path.reserve(cells.size());
+	for (Vec2& cell : cells)
+		path.emplace_back(grid->GetCell((unsigned int)cell.x, (unsigned int)cell.y));
+
+	SetContext(Keys::Path, path);
+	SetContext(Keys::Target, sourceID);
+	SetContext(Keys::Found, sourceID);
+	return BehaviourResult::Success;
+}
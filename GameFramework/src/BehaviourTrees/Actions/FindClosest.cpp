@@ -1,35 +1,28 @@
+#include <Framework/BehaviourTrees/PerceptionService.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/FindClosest.hpp>
 
 using namespace std;
+using namespace Framework;
 using namespace Framework::BT;
 
 BehaviourResult FindClosest::Execute(GameObject* go)
 {
+	float sight = Sight;
+	string targetTag = TargetTag;
 	if (GetTargetFromContext)
 	{
-		Sight = GetContext<float>("Sight", 10000.0f);
-		TargetTag = GetContext<string>("TargetTag");
+		sight = GetContext<float>(Keys::Sight, 10000.0f);
+		targetTag = GetContext<string>(Keys::TargetTag);
 	}
 
-	vector<GameObject*> queryList = TargetTag.empty() ? GameObject::GetAll() : GameObject::GetTag(TargetTag);
-
-	if (queryList.size() == 0)
+	// Only tagged GameObjects are spatially indexed, empty tag searches any of them
+	TagMask mask = targetTag.empty() ? AnyTag : GameObject::GetTagMask(targetTag);
+	GameObject* closest = PerceptionService::FindNearestNeighbour(go, sight, mask);
+	if (!closest)
 		return BehaviourResult::Failure;
 
-	Vec2 position = go->GetPosition();
-	GameObject* closest = queryList[0];
-	float closestDistance = closest->GetPosition().Distance(position);
-
-	for (unsigned int i = 1; i < queryList.size(); i++)
-	{
-		float distance = queryList[i]->GetPosition().Distance(position);
-		if (distance >= closestDistance || distance >= Sight)
-			continue;
-		closest = queryList[i];
-		closestDistance = distance;
-	}
-
-	SetContext("Target", closest->GetID());
-	SetContext("Found", closest->GetID());
+	SetContext(Keys::Target, closest->GetID());
+	SetContext(Keys::Found, closest->GetID());
 	return BehaviourResult::Success;
 }
\ No newline at end of file
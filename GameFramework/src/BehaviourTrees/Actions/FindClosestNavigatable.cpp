@@ -1,3 +1,7 @@
+#include <cmath>
+#include <Framework/Logger.hpp>
+#include <Framework/BehaviourTrees/PerceptionService.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/FindClosestNavigatable.hpp>
 
 using namespace std;
@@ -11,16 +15,9 @@ void FindClosestNavigatable::CopyGrid(SquareGrid* grid)
 {
 	if (!m_Grid)
 	{
-		cout << "CREATING NEW GRID" << endl;
+		FRAMEWORK_LOG_DEBUG(Logger::NoAgent, "FindClosestNavigatable", "Creating %ux%u search grid", grid->GetWidth(), grid->GetHeight());
 		m_Grid = new Grid<SquareGridNode>(grid->GetWidth(), grid->GetHeight());
 	}
-	SetContext("AStarGrid", m_Grid);
-
-	if (!m_AStar)
-	{
-		m_AStar = new AStar();
-		SetContext("AStar", m_AStar);
-	}
 
 	for (unsigned int x = 0; x < grid->GetWidth(); x++)
 	{
@@ -36,125 +33,77 @@ void FindClosestNavigatable::CopyGrid(SquareGrid* grid)
 	m_Grid->RefreshNodes();
 }
 
-void FindClosestNavigatable::ExecuteFinding(Vec2 position, vector<GameObject*> queryList, float cellSize)
+BehaviourResult FindClosestNavigatable::Resume(GameObject* go, CoroutineFrame<FindClosestNavigatableLocals>& co)
 {
-	// Reset
-	m_FindThreadStarted.store(true);
-	m_FindThreadFinished.store(false);
-	m_FoundClosest = nullptr;
-	m_FoundPath = vector<AStarCell*>();
+	SquareGrid* grid = m_Grid ? m_Grid : GetContext<SquareGrid*>(Keys::AStarGrid, nullptr);
+	if (!grid) // CopyGrid was never called
+		return BehaviourResult::Failure;
 
-	float smallestFScore = 99999;
-	float closestDistance = 99999;
+	float cellSize = GetContext<float>(Keys::CellSize, 1.0f);
 
-	Vec2 startPos = position / cellSize;
-	for (unsigned int i = 0; i < queryList.size(); i++)
+	BT_COROUTINE_BEGIN(co);
 	{
-		Vec2 endPos = queryList[i]->GetPosition();
-		float distance = endPos.Distance(position);
-		if (distance >= closestDistance || distance >= Sight)
-			continue;
-		endPos /= cellSize;
-
-		if (startPos.x == endPos.x && startPos.y == endPos.y)
+		float sight = Sight;
+		TagMask targetMask;
+		if (GetTargetFromContext)
 		{
-			// Already at target
-			m_FindThreadFinished.store(true);
-
-#ifdef TRY_MULTITHREADING
-			lock_guard<mutex> lock(m_FindThreadMutex);
-#endif
-			m_FindThreadResult = BehaviourResult::Success;
-			return;
+			sight = GetContext<float>(Keys::Sight, 10000.0f);
+			vector<string> targetTags = GetContext(Keys::TargetTags, vector<string>());
+			if (ContextExists(Keys::TargetTag))
+				targetTags.emplace_back(GetContext<string>(Keys::TargetTag));
+			targetMask = targetTags.empty() ? AnyTag : GameObject::GetTagMask(targetTags);
 		}
-
-		m_AStar->StartSearch(
-			m_Grid->GetCell((unsigned int)startPos.x, (unsigned int)startPos.y),
-			m_Grid->GetCell((unsigned int)  endPos.x, (unsigned int)  endPos.y)
-		);
-
-		m_AStar->Finish();
-
-		if (!m_AStar->IsPathValid() || m_AStar->GetSmallestFScore() > smallestFScore)
-			continue;
-
-		m_FoundClosest = queryList[i];
-		closestDistance = distance;
-		m_FoundPath = m_AStar->GetPath();
-		smallestFScore = m_AStar->GetSmallestFScore();
-	}
-
-	m_FindThreadStarted.store(false);
-	m_FindThreadFinished.store(true);
-#ifdef TRY_MULTITHREADING
-	lock_guard<mutex> lock(m_FindThreadMutex);
-#endif
-
-	m_FindThreadResult = m_FoundClosest ? BehaviourResult::Success : BehaviourResult::Failure;
-}
-
-BehaviourResult FindClosestNavigatable::Execute(GameObject* go)
-{
-	if (!m_Grid || !m_AStar)
-	{
-		m_AStar = GetContext<AStar*>("AStar", nullptr);
-		m_Grid = GetContext<SquareGrid*>("AStarGrid", nullptr);
-
-		if (!m_AStar || !m_Grid) // CopyGrid was never called
-			return BehaviourResult::Failure;
+		else
+			targetMask = TargetTags.empty() ? AnyTag : GameObject::GetTagMask(TargetTags);
+
+		// Candidates within sight, closest first so the first one reachable is the closest
+		vector<GameObject*> queryList;
+		PerceptionService::QueryNeighbours(go, sight, targetMask, queryList);
+		if (queryList.empty())
+			BT_COROUTINE_RETURN(BehaviourResult::Failure);
+
+		Vec2 startPos = go->GetPosition() / cellSize;
+		co.Locals.Start = grid->GetCell((unsigned int)floorf(startPos.x), (unsigned int)floorf(startPos.y));
+		co.Locals.Candidates.reserve(queryList.size());
+		for (GameObject* candidate : queryList)
+			co.Locals.Candidates.emplace_back(candidate->GetID());
 	}
 
-	if (!m_FindThreadStarted.load() && !m_FindThreadFinished.load())
+	// One search per candidate, each spread over as many updates as it needs
+	for (; co.Locals.Next < co.Locals.Candidates.size(); co.Locals.Next++)
 	{
-		if (GetTargetFromContext)
 		{
-			Sight = GetContext<float>("Sight", 10000.0f);
-			TargetTags = GetContext("TargetTags", vector<string>());
-			if (ContextExists("TargetTag"))
-				TargetTags.emplace_back(GetContext<string>("TargetTarget"));
+			GameObject* candidate = GameObject::FromID(co.Locals.Candidates[co.Locals.Next]);
+			if (!candidate) // Destroyed while searching for a closer one
+				continue;
+
+			Vec2 endPos = candidate->GetPosition() / cellSize;
+			AStarCell* end = grid->GetCell((unsigned int)floorf(endPos.x), (unsigned int)floorf(endPos.y));
+			if (end && end == co.Locals.Start)
+			{
+				// Already at target
+				SetContext(Keys::Path, vector<AStarCell*>());
+				SetContext(Keys::Target, candidate->GetID());
+				SetContext(Keys::Found, candidate->GetID());
+				BT_COROUTINE_RETURN(BehaviourResult::Success);
+			}
+
+			co.Locals.Search = PathTicket(co.Locals.Start, end, StepsPerUpdate);
 		}
-
-		vector<GameObject*> queryList = TargetTags.empty() ? GameObject::GetAll() : vector<GameObject*>();
-
-		for (string& tag : TargetTags)
+		BT_AWAIT(co, co.Locals.Search);
 		{
-			// GameObject with multiple occurring or target tags may be added twice
-
-			vector<GameObject*> tagged = GameObject::GetTag(tag);
-			queryList.insert(queryList.end(), tagged.begin(), tagged.end());
+			GameObject* candidate = GameObject::FromID(co.Locals.Candidates[co.Locals.Next]);
+			vector<AStarCell*> path = co.Locals.Search.GetPath();
+			if (!candidate || path.size() <= 1)
+				continue;
+
+			SetContext(Keys::Path, move(path));
+			SetContext(Keys::Target, candidate->GetID());
+			SetContext(Keys::Found, candidate->GetID());
+			BT_COROUTINE_RETURN(BehaviourResult::Success);
 		}
-
-		if (queryList.size() == 0 || !m_Grid)
-			return BehaviourResult::Failure;
-
-#ifndef TRY_MULTITHREADING
-		ExecuteFinding(go->GetPosition(), queryList, GetContext<float>("CellSize", 1.0f));
-#else
-		Vec2 startPos = go->GetPosition();
-		float cellSize = GetContext<float>("CellSize", 1.0f);
-		m_FindThread = thread([=]() { ExecuteFinding(startPos, queryList, cellSize); });
-#endif
 	}
+	BT_COROUTINE_RETURN(BehaviourResult::Failure);
 
-	// Check if still processing
-	if (!m_FindThreadFinished.load())
-		return BehaviourResult::Pending;
-
-	// Reset
-#ifdef TRY_MULTITHREADING
-	lock_guard<mutex> guard(m_FindThreadMutex);
-	m_FindThread.join();
-#endif
-	
-	m_FindThreadStarted.store(false);
-	m_FindThreadFinished.store(false);
-
-	if (m_FindThreadResult == BehaviourResult::Success)
-	{
-		SetContext("Path", m_FoundPath);
-		SetContext("Target", m_FoundClosest->GetID());
-		SetContext("Found", m_FoundClosest->GetID());
-	}
-
-	return m_FindThreadResult;
-}
\ No newline at end of file
+	BT_COROUTINE_END(co);
+}
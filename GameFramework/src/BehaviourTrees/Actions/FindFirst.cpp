@@ -1,3 +1,4 @@
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/FindFirst.hpp>
 
 using namespace std;
@@ -5,17 +6,15 @@ using namespace Framework::BT;
 
 BehaviourResult FindFirst::Execute(GameObject* go)
 {
-	if (GetTagFromContext)
-		Tag = GetContext<string>("TargetTag");
-
-	if (Tag.empty())
+	string tag = GetTagFromContext ? GetContext<string>(Keys::TargetTag) : Tag;
+	if (tag.empty())
 		return BehaviourResult::Failure;
 
-	auto gameObjects = GameObject::GetTag(Tag);
+	auto gameObjects = GameObject::GetTag(tag);
 	if (gameObjects.empty())
 		return BehaviourResult::Failure;
 
-	SetContext("Found", gameObjects[0]->GetID());
-	SetContext("Target", gameObjects[0]->GetID());
+	SetContext(Keys::Found, gameObjects[0]->GetID());
+	SetContext(Keys::Target, gameObjects[0]->GetID());
 	return BehaviourResult::Success;
 }
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include <Framework/Logger.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/FindPath.hpp>
 
 using namespace std;
@@ -18,16 +20,18 @@ void FindPath::CopyGrid(SquareGrid* grid)
 	m_Grid->RefreshNodes();
 }
 
-BehaviourResult FindPath::Execute(GameObject* go)
+BehaviourResult FindPath::Resume(GameObject* go, CoroutineFrame<FindPathLocals>& co)
 {
 	if (!m_Grid)
 		return BehaviourResult::Failure;
 
-	if (!m_Started)
+	BT_COROUTINE_BEGIN(co);
 	{
-		float cellSize = GetContext("CellSize", 1.0f);
-		unsigned int targetID = GetContext<unsigned int>("Target", -1);
+		float cellSize = GetContext(Keys::CellSize, 1.0f);
+		unsigned int targetID = GetContext<unsigned int>(Keys::Target, -1);
 		GameObject* target = GameObject::FromID(targetID);
+		if (!target)
+			BT_COROUTINE_RETURN(BehaviourResult::Failure);
 
 		Vec2 startPos = go->GetPosition() / cellSize;
 		startPos.x = floorf(startPos.x);
@@ -39,33 +43,22 @@ BehaviourResult FindPath::Execute(GameObject* go)
 
 		if (startPos.x == endPos.x && startPos.y == endPos.y)
 		{
-			SetContext("Path", vector<AStarCell*>());
-			return BehaviourResult::Success; // Already there! :)
+			SetContext(Keys::Path, vector<AStarCell*>());
+			BT_COROUTINE_RETURN(BehaviourResult::Success); // Already there! :)
 		}
 
-		cout << "{" << go->GetID() << "}" << go->GetPosition() << startPos << " is pathfinding to {" << targetID << "}" << endPos << target->GetPosition() << endl;
-		if (!target)
-			return BehaviourResult::Failure;
+		FRAMEWORK_LOG_DEBUG(go->GetID(), "FindPath", "Pathfinding from (%.0f, %.0f) to {%u} at (%.0f, %.0f)",
+			startPos.x, startPos.y, targetID, endPos.x, endPos.y);
 		auto start = m_Grid->GetCell((unsigned int)startPos.x, (unsigned int)startPos.y);
 		auto end = m_Grid->GetCell((unsigned int)endPos.x, (unsigned int)endPos.y);
-		m_AStar.StartSearch(start, end);
-
-		m_Started = true;
-		cout << "RECALCULATING A*" << endl;
-		return BehaviourResult::Pending;
+		co.Locals.Search = PathTicket(start, end, StepsPerUpdate);
 	}
-
-	if (!m_AStar.IsFinished())
+	BT_AWAIT(co, co.Locals.Search);
 	{
-		for (unsigned int i = 0; i < StepsPerUpdate; i++)
-			m_AStar.Step();
-
-		SetContext("Path", m_AStar.GetPath());
-
-		return BehaviourResult::Pending;
+		vector<AStarCell*> path = co.Locals.Search.GetPath();
+		bool found = path.size() > 1;
+		SetContext(Keys::Path, move(path));
+		BT_COROUTINE_RETURN(found ? BehaviourResult::Success : BehaviourResult::Failure);
 	}
-
-	m_Started = false; // Finished
-	SetContext("Path", m_AStar.GetPath());
-	return m_AStar.GetPath().size() > 1 ? BehaviourResult::Success : BehaviourResult::Failure;
+	BT_COROUTINE_END(co);
 }
\ No newline at end of file
@@ -9,19 +9,20 @@ BehaviourResult LimitTime::Execute(GameObject* go)
 	if (!child)
 		return BehaviourResult::Failure;
 
-	if (m_TimeLeft < 0)
-		m_TimeLeft = m_MaxTime;
+	float& timeLeft = GetState();
+	if (timeLeft < 0)
+		timeLeft = m_MaxTime;
 
-	m_TimeLeft -= GetFrameTime();
-	if (m_TimeLeft <= 0)
+	timeLeft -= GetDeltaTime();
+	if (timeLeft <= 0)
 	{
 		// Child took too long
-		m_TimeLeft = -1.0f;
+		timeLeft = -1.0f;
 		return BehaviourResult::Failure;
 	}
 
-	auto result = child->Execute(go);
+	auto result = child->Tick(go);
 	return result;
 }
 
-void LimitTime::SetTime(float time) { m_TimeLeft = m_MaxTime = time; }
+void LimitTime::SetTime(float time) { m_MaxTime = time; }
@@ -1,16 +1,20 @@
 #include <iostream>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/Move.hpp>
 
 using namespace Framework::BT;
 
 BehaviourResult Move::Execute(GameObject* go)
 {
+	float speed = Speed;
+	Vec2 direction = Direction;
 	if (GetValuesFromContext)
 	{
-		Speed = GetContext("Speed", Speed);
-		Direction = GetContext("Direction", Direction);
+		speed = GetContext(Keys::Speed, Speed);
+		direction = GetContext(Keys::Direction, Direction);
 	}
 
-	go->SetPosition(go->GetPosition() + Direction * Speed * GetFrameTime());
+	Vec2 position = go->GetPosition() + direction * speed * GetDeltaTime();
+	Defer([go, position]() { go->SetPosition(position); });
 	return BehaviourResult::Success;
 }
\ No newline at end of file
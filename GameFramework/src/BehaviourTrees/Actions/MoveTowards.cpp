@@ -1,19 +1,22 @@
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/MoveTowards.hpp>
 
 using namespace Framework::BT;
 
 BehaviourResult MoveTowards::Execute(GameObject* go)
 {
+	float speed = Speed;
+	unsigned int targetID = TargetID;
 	if (GetValuesFromContext)
 	{
-		TargetID = GetContext<unsigned int>("Target", -1);
-		Speed = GetContext("Speed", Speed <= 0 ? 100.0f : Speed);
+		targetID = GetContext<unsigned int>(Keys::Target, -1);
+		speed = GetContext(Keys::Speed, Speed <= 0 ? 100.0f : Speed);
 	}
 
-	if (TargetID == (unsigned int)-1)
+	if (targetID == (unsigned int)-1)
 		return BehaviourResult::Failure;
 
-	GameObject* target = GameObject::FromID(TargetID);
+	GameObject* target = GameObject::FromID(targetID);
 	Vec2 position = go->GetPosition();
 	Vec2 targetVel = (target->GetPosition() - position).Normalized();
 
@@ -22,6 +25,7 @@ BehaviourResult MoveTowards::Execute(GameObject* go)
 	go->SetRotation(rotation * 50.0f);
 	*/
 
-	go->SetPosition(position + go->GetForward() * Speed * GetFrameTime());
+	position = position + go->GetForward() * speed * GetDeltaTime();
+	Defer([go, position]() { go->SetPosition(position); });
 	return BehaviourResult::Success;
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
+#include <cmath>
 #include <vector>
+#include <algorithm>
 #include <Framework/Pathfinding/AStar.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/NavigatePath.hpp>
 
 using namespace std;
@@ -8,48 +11,62 @@ using namespace Framework::Pathfinding;
 
 BehaviourResult NavigatePath::Execute(GameObject* go)
 {
-	if (!ContextExists("Path"))
+	if (!ContextExists(Keys::Path))
 		return BehaviourResult::Failure;
 
-	m_GridSize = GetContext("CellSize", 1.0f);
-	m_Path = GetContext("Path", vector<AStarCell*>());
-	Speed = GetContext("Speed", Speed <= 0 ? 100.0f : Speed);
+	float gridSize = GetContext(Keys::CellSize, 1.0f);
+	float speed = GetContext(Keys::Speed, Speed <= 0 ? 100.0f : Speed);
+	vector<AStarCell*>& path = GetContextRef(Keys::Path);
 
-	if (m_Path.empty()) // No path present, or finished navigating
+	if (path.empty()) // No path present, or finished navigating
 		return BehaviourResult::Success;
 
 	Vec2 position = go->GetPosition();
-	Vec2 targetPos = Vec2 { m_Path[0]->x, m_Path[0]->y } * m_GridSize + go->GetSize() / 2.0f;
-	Vec2 difference = targetPos - position;
-	float magnitude = difference.MagnitudeSqr();
-	
-	// Check for at next point in path
-	if (magnitude < 1.0f)
+	Vec2 halfSize = go->GetSize() / 2.0f;
+
+	// Spend the whole frame's movement, carrying on past reached points so
+	// agents ticked less often still cover the same ground
+	float timeLeft = GetDeltaTime();
+	while (!path.empty() && timeLeft > 0.0f)
 	{
-		m_Path.erase(m_Path.begin()); // Remove first element, navigate to next
-		SetContext("Path", m_Path);
+		Vec2 targetPos = Vec2 { path[0]->x, path[0]->y } * gridSize + halfSize;
+		Vec2 difference = targetPos - position;
+		float distance = sqrtf(difference.MagnitudeSqr());
+		float cellSpeed = speed / path[0]->Cost;
 
-		if (m_Path.empty())
+		if (distance > cellSpeed * timeLeft)
 		{
-			ClearContext("Path");
-			return BehaviourResult::Success;
+			Vec2 velocity = difference.Normalized() * (cellSpeed * timeLeft);
+			position += velocity;
+			break;
 		}
-		return BehaviourResult::Pending;
-	}
 
-	Vec2 direction = difference.Normalized();
-	float speed = Speed / m_Path[0]->Cost;
-	go->SetPosition(go->GetPosition() + direction * speed * GetFrameTime());
+		// Reached next point in path, remove it and keep moving towards the one after
+		position = targetPos;
+		timeLeft -= distance / cellSpeed;
+		path.erase(path.begin());
+	}
+	Defer([go, position]() { go->SetPosition(position); });
 
+	if (path.empty())
+	{
+		ClearContext(Keys::Path);
+		return BehaviourResult::Success;
+	}
 	return BehaviourResult::Pending;
 }
 
 void NavigatePath::OnDebugDraw(GameObject* go)
 {
-	for(unsigned int i = 0; i < m_Path.size(); i++)
+	if (!ContextExists(Keys::Path))
+		return;
+
+	float gridSize = GetContext(Keys::CellSize, 1.0f);
+	vector<AStarCell*>& path = GetContextRef(Keys::Path);
+	for(unsigned int i = 0; i < path.size(); i++)
 	{
-		Vec2 pos = { m_Path[i]->x, m_Path[i]->y };
-		pos *= m_GridSize;
+		Vec2 pos = { path[i]->x, path[i]->y };
+		pos *= gridSize;
 		DrawCircle((int)pos.x, (int)pos.y, 5.0f, RED);
 	}
-}
\ No newline at end of file
+}
@@ -1,27 +1,28 @@
 #include <raylib.h>
-#include <iostream>
 #include <Framework/BehaviourTrees/Actions/PlaySound.hpp>
 
 using namespace Framework::BT;
 
-PlaySound::PlaySound() : WaitForFinish(true), Sound({}), m_PlayTime(-1.0f) { }
+PlaySound::PlaySound() : WaitForFinish(true), Sound({}) { }
 
-BehaviourResult PlaySound::Execute(GameObject* go)
+BehaviourResult PlaySound::Resume(GameObject* go, CoroutineFrame<PlaySoundLocals>& co)
 {
 	if (Sound.sampleCount == 0 || !Sound.stream.buffer)
 		return BehaviourResult::Failure;
 
-	if (!IsSoundPlaying(Sound) && m_PlayTime < 0)
-	{
-		::PlaySound(Sound); // Raylib function
-		m_PlayTime = (float)Sound.sampleCount / (Sound.stream.sampleRate * Sound.stream.channels);
-		return BehaviourResult::Pending;
-	}
+	BT_COROUTINE_BEGIN(co);
 
+	// Sound is shared between agents, don't restart it. Raylib's audio isn't thread safe
+	Defer([this]()
+	{
+		if (!IsSoundPlaying(Sound))
+			::PlaySound(Sound); // Raylib function
+	});
 	if (!WaitForFinish)
-		return BehaviourResult::Success;
+		BT_COROUTINE_RETURN(BehaviourResult::Success);
 
-	m_PlayTime -= GetFrameTime();
+	co.Locals.Playing = Timer((float)Sound.sampleCount / (Sound.stream.sampleRate * Sound.stream.channels));
+	BT_AWAIT(co, co.Locals.Playing);
 
-	return m_PlayTime > 0 ? BehaviourResult::Pending : BehaviourResult::Success;
+	BT_COROUTINE_END(co);
 }
\ No newline at end of file
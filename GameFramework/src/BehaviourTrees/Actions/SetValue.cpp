@@ -1,9 +1,7 @@
+#include <Framework/Logger.hpp>
 #include <Framework/BehaviourTrees/Actions/SetValue.hpp>
 
-#ifndef NDEBUG
-#include <iostream>
-#endif
-
+using namespace Framework;
 using namespace Framework::BT;
 
 void SetValue::Set(std::string name, void* value)
@@ -17,8 +15,6 @@ std::string& SetValue::GetValueName() { return m_Name; }
 BehaviourResult SetValue::Execute(GameObject* go)
 {
 	SetContext(m_Name, m_Value);
-#ifndef NDEBUG
-	std::cout << "[BT::SetValue] '" << m_Name << "' = " << m_Value << std::endl;
-#endif
+	FRAMEWORK_LOG_DEBUG(go ? go->GetID() : Logger::NoAgent, "SetValue", "'%s' = %p", m_Name.c_str(), m_Value);
 	return BehaviourResult::Success;
 }
\ No newline at end of file
@@ -1,23 +1,26 @@
-#include <raylib.h>
 #include <Framework/BehaviourTrees/Actions/Wait.hpp>
 
+using namespace std;
 using namespace Framework::BT;
 
-Wait::Wait() : m_TimeLeft(1.0f), m_WaitTime(1.0f) { }
+Wait::Wait() : m_WaitTime(1.0f) { }
 
-float& Wait::GetTimeLeft() { return m_TimeLeft; }
-float& Wait::GetWaitTime() { return m_WaitTime; }
-
-void Wait::SetTime(float time)
+float Wait::GetTimeLeft()
 {
-	m_TimeLeft = m_WaitTime = time;
+	CoroutineFrame<WaitLocals>& co = GetState();
+	return co.Line == 0 ? m_WaitTime : co.Locals.Delay.GetTimeLeft();
 }
 
-BehaviourResult Wait::Execute(GameObject* go)
+float& Wait::GetWaitTime() { return m_WaitTime; }
+
+void Wait::SetTime(float time) { m_WaitTime = time; }
+
+BehaviourResult Wait::Resume(GameObject* go, CoroutineFrame<WaitLocals>& co)
 {
-	m_TimeLeft -= GetFrameTime();
-	if (m_TimeLeft > 0)
-		return BehaviourResult::Pending;
-	m_TimeLeft = m_WaitTime;
-	return BehaviourResult::Success;
+	BT_COROUTINE_BEGIN(co);
+
+	co.Locals.Delay = Timer(m_WaitTime);
+	BT_AWAIT(co, co.Locals.Delay);
+
+	BT_COROUTINE_END(co);
 }
\ No newline at end of file
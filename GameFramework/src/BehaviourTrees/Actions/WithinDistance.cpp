@@ -1,16 +1,18 @@
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
 #include <Framework/BehaviourTrees/Actions/WithinDistance.hpp>
 
 using namespace Framework::BT;
 
 BehaviourResult WithinDistance::Execute(GameObject* go)
 {
+	unsigned int targetID = TargetID;
 	if (GetTargetFromContext)
-		TargetID = GetContext("Target", TargetID > 0 ? TargetID : (unsigned int)-1);
+		targetID = GetContext(Keys::Target, TargetID > 0 ? TargetID : (unsigned int)-1);
 
-	if (TargetID == (unsigned int)-1)
+	if (targetID == (unsigned int)-1)
 		return BehaviourResult::Failure;
 
-	GameObject* target = GameObject::FromID(TargetID);
+	GameObject* target = GameObject::FromID(targetID);
 	return go->GetPosition().Distance(target->GetPosition()) < MaxDistance ?
 		BehaviourResult::Success : BehaviourResult::Failure;
 }
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_set>
+#include <Framework/BehaviourTrees/BehaviourProfiler.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+bool BehaviourProfiler::m_Enabled = false;
+unsigned long long BehaviourProfiler::m_Frames = 0;
+vector<BehaviourProfiler::Sample> BehaviourProfiler::m_Stack;
+unordered_map<BehaviourNode*, BehaviourNodeStats> BehaviourProfiler::m_NodeStats;
+vector<pair<string, BehaviourNode*>> BehaviourProfiler::m_Trees;
+
+void BehaviourNodeStats::Add(const BehaviourNodeStats& other)
+{
+	Calls += other.Calls;
+	InclusiveNs += other.InclusiveNs;
+	ExclusiveNs += other.ExclusiveNs;
+	for (int i = 0; i < 3; i++)
+		Results[i] += other.Results[i];
+}
+
+void BehaviourProfiler::SetEnabled(bool enabled)
+{
+	m_Enabled = enabled;
+	m_Stack.clear();
+}
+
+void BehaviourProfiler::Reset()
+{
+	m_Frames = 0;
+	m_Stack.clear();
+	m_NodeStats.clear();
+}
+
+void BehaviourProfiler::EndFrame()
+{
+	if (m_Enabled)
+		m_Frames++;
+}
+
+void BehaviourProfiler::Begin(BehaviourNode* node) { m_Stack.emplace_back(Sample { node, Clock::now(), 0 }); }
+
+void BehaviourProfiler::End(BehaviourNode* node, BehaviourResult result)
+{
+	// Can be empty if profiling was enabled mid-execution
+	if (m_Stack.empty() || m_Stack.back().Node != node)
+		return;
+
+	Sample sample = m_Stack.back();
+	m_Stack.pop_back();
+
+	unsigned long long inclusive = (unsigned long long)chrono::duration_cast<chrono::nanoseconds>(Clock::now() - sample.Start).count();
+	if (!m_Stack.empty())
+		m_Stack.back().ChildNs += inclusive;
+
+	BehaviourNodeStats& stats = m_NodeStats[node];
+	stats.Calls++;
+	stats.InclusiveNs += inclusive;
+	stats.ExclusiveNs += inclusive - min(sample.ChildNs, inclusive);
+	stats.Results[(int)result]++;
+}
+
+void BehaviourProfiler::RegisterTree(const string& name, BehaviourNode* root)
+{
+	UnregisterTree(root);
+	m_Trees.emplace_back(name, root);
+}
+
+void BehaviourProfiler::UnregisterTree(BehaviourNode* root)
+{
+	m_Trees.erase(remove_if(m_Trees.begin(), m_Trees.end(),
+		[=](const pair<string, BehaviourNode*>& tree) { return tree.second == root; }), m_Trees.end());
+
+	// Drop stats of nodes about to be destroyed, addresses may be reused
+	vector<BehaviourNode*> stack = { root };
+	while (!stack.empty())
+	{
+		BehaviourNode* node = stack.back();
+		stack.pop_back();
+		m_NodeStats.erase(node);
+		node->GetChildNodes(stack);
+	}
+}
+
+void BehaviourProfiler::CollectRows(BehaviourNode* node, const string& path, vector<Row>& output)
+{
+	auto it = m_NodeStats.find(node);
+	output.emplace_back(Row { path, node->GetName(), it != m_NodeStats.end() ? it->second : BehaviourNodeStats() });
+
+	vector<BehaviourNode*> children;
+	node->GetChildNodes(children);
+	for (size_t i = 0; i < children.size(); i++)
+	{
+		// Labelled subtrees keep a stable path, otherwise disambiguate siblings by index
+		BehaviourNode* child = children[i];
+		string name = child->Label.empty() ? child->GetName() + "[" + to_string(i) + "]" : child->Label;
+		CollectRows(child, path + "/" + name, output);
+	}
+}
+
+vector<BehaviourProfiler::Row> BehaviourProfiler::GetNodeRows()
+{
+	vector<Row> rows;
+	for (auto& tree : m_Trees)
+		CollectRows(tree.second, tree.first, rows);
+
+	// Nodes that executed outside of a registered tree
+	unordered_set<BehaviourNode*> reported;
+	vector<BehaviourNode*> stack;
+	for (auto& tree : m_Trees)
+		stack.push_back(tree.second);
+	while (!stack.empty())
+	{
+		BehaviourNode* node = stack.back();
+		stack.pop_back();
+		reported.insert(node);
+		node->GetChildNodes(stack);
+	}
+	for (auto& pair : m_NodeStats)
+		if (reported.find(pair.first) == reported.end())
+			rows.emplace_back(Row { "?/" + pair.first->GetName(), pair.first->GetName(), pair.second });
+
+	return rows;
+}
+
+vector<BehaviourProfiler::Row> BehaviourProfiler::GetTypeRows(const vector<Row>& nodeRows)
+{
+	vector<Row> rows;
+	unordered_map<string, size_t> indices;
+	for (const Row& node : nodeRows)
+	{
+		auto it = indices.find(node.Type);
+		if (it == indices.end())
+		{
+			indices.emplace(node.Type, rows.size());
+			rows.emplace_back(Row { node.Type, node.Type, node.Stats });
+		}
+		else
+			rows[it->second].Stats.Add(node.Stats);
+	}
+
+	sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.Stats.ExclusiveNs > b.Stats.ExclusiveNs; });
+	return rows;
+}
+
+string BehaviourProfiler::ToCSV()
+{
+	vector<Row> nodes = GetNodeRows();
+	vector<Row> types = GetTypeRows(nodes);
+
+	stringstream ss;
+	ss << "Scope,Path,Type,Calls,InclusiveMs,ExclusiveMs,Success,Failure,Pending\n";
+	auto write = [&](const char* scope, const Row& row)
+	{
+		const BehaviourNodeStats& stats = row.Stats;
+		ss << scope << ",\"" << row.Path << "\"," << row.Type << ',' << stats.Calls << ','
+			<< stats.InclusiveNs / 1.0e6 << ',' << stats.ExclusiveNs / 1.0e6 << ','
+			<< stats.Results[(int)BehaviourResult::Success] << ','
+			<< stats.Results[(int)BehaviourResult::Failure] << ','
+			<< stats.Results[(int)BehaviourResult::Pending] << '\n';
+	};
+	for (const Row& row : types)
+		write("Type", row);
+	for (const Row& row : nodes)
+		write("Node", row);
+	return ss.str();
+}
+
+static string EscapeJSON(const string& value)
+{
+	string output;
+	output.reserve(value.size());
+	for (char c : value)
+	{
+		if (c == '"' || c == '\\')
+			output += '\\';
+		output += c;
+	}
+	return output;
+}
+
+string BehaviourProfiler::ToJSON()
+{
+	vector<Row> nodes = GetNodeRows();
+	vector<Row> types = GetTypeRows(nodes);
+
+	stringstream ss;
+	auto write = [&](const vector<Row>& rows)
+	{
+		for (size_t i = 0; i < rows.size(); i++)
+		{
+			const BehaviourNodeStats& stats = rows[i].Stats;
+			ss << "\n\t\t{ \"path\": \"" << EscapeJSON(rows[i].Path) << "\", \"type\": \"" << EscapeJSON(rows[i].Type)
+				<< "\", \"calls\": " << stats.Calls
+				<< ", \"inclusiveMs\": " << stats.InclusiveNs / 1.0e6
+				<< ", \"exclusiveMs\": " << stats.ExclusiveNs / 1.0e6
+				<< ", \"success\": " << stats.Results[(int)BehaviourResult::Success]
+				<< ", \"failure\": " << stats.Results[(int)BehaviourResult::Failure]
+				<< ", \"pending\": " << stats.Results[(int)BehaviourResult::Pending] << " }"
+				<< (i + 1 < rows.size() ? "," : "");
+		}
+	};
+
+	ss << "{\n\t\"frames\": " << m_Frames << ",\n\t\"types\": [";
+	write(types);
+	ss << "\n\t],\n\t\"nodes\": [";
+	write(nodes);
+	ss << "\n\t]\n}\n";
+	return ss.str();
+}
+
+bool BehaviourProfiler::SaveCSV(const string& path)
+{
+	ofstream file(path);
+	if (!file)
+		return false;
+	file << ToCSV();
+	return true;
+}
+
+bool BehaviourProfiler::SaveJSON(const string& path)
+{
+	ofstream file(path);
+	if (!file)
+		return false;
+	file << ToJSON();
+	return true;
+}
+
+void BehaviourProfiler::DrawOverlay(Font font, Vector2 position, float fontSize, unsigned int maxRows)
+{
+	vector<Row> types = GetTypeRows(GetNodeRows());
+	double frames = (double)max(m_Frames, 1ull);
+
+	char line[256];
+	snprintf(line, sizeof(line), "%-24s %10s %10s %10s %6s %6s %6s", "Node", "Calls/f", "Excl ms/f", "Incl ms/f", "S%", "F%", "P%");
+	DrawTextEx(font, line, position, fontSize, 1.0f, RAYWHITE);
+
+	for (unsigned int i = 0; i < types.size() && i < maxRows; i++)
+	{
+		const BehaviourNodeStats& stats = types[i].Stats;
+		double calls = (double)max(stats.Calls, 1ull);
+		snprintf(line, sizeof(line), "%-24s %10.1f %10.3f %10.3f %6.1f %6.1f %6.1f",
+			types[i].Type.c_str(),
+			stats.Calls / frames,
+			stats.ExclusiveNs / 1.0e6 / frames,
+			stats.InclusiveNs / 1.0e6 / frames,
+			100.0 * stats.Results[(int)BehaviourResult::Success] / calls,
+			100.0 * stats.Results[(int)BehaviourResult::Failure] / calls,
+			100.0 * stats.Results[(int)BehaviourResult::Pending] / calls);
+		DrawTextEx(font, line, { position.x, position.y + fontSize * (i + 1) }, fontSize, 1.0f, RAYWHITE);
+	}
+}
@@ -1,16 +1,83 @@
 #include <raylib.h>
 #include <Framework/BehaviourTrees/BehaviourTree.hpp>
 
+using namespace std;
 using namespace Framework;
 using namespace Framework::BT;
 
-BehaviourTree::BehaviourTree(GameObject* parent) : m_Parent(parent)
+BehaviourTree::BehaviourTree(GameObject* parent) : BehaviourTree(parent, make_shared<BehaviourTreeDefinition>()) { }
+
+BehaviourTree::BehaviourTree(GameObject* parent, shared_ptr<BehaviourTreeDefinition> definition) :
+	m_Definition(definition), m_Blackboard(), m_State(nullptr), m_Progress(), m_SleepVersion(0), m_SleptTime(0.0f), m_Parent(parent) { }
+
+BehaviourTree::~BehaviourTree() { DestroyState(); }
+
+void BehaviourTree::CreateState()
+{
+	m_Definition->Finalise();
+	m_State = (char*)::operator new(max(m_Definition->GetStateSize(), (size_t)1));
+	m_Definition->ConstructState(m_State);
+}
+
+void BehaviourTree::DestroyState()
+{
+	if (!m_State)
+		return;
+	m_Definition->DestructState(m_State);
+	::operator delete(m_State);
+	m_State = nullptr;
+	m_Progress = {};
+	m_SleptTime = 0.0f;
+}
+
+void BehaviourTree::Clear()
+{
+	m_Blackboard.Clear();
+	DestroyState();
+}
+
+void BehaviourTree::Wake() { m_Progress.WakeTime = 0.0; }
+
+bool BehaviourTree::IsSleeping()
+{
+	return m_State && m_Blackboard.GetVersion() == m_SleepVersion && GetTime() < m_Progress.WakeTime;
+}
+
+void BehaviourTree::Update() { Update(GetFrameTime()); }
+
+void BehaviourTree::Prepare()
+{
+	if (!m_State)
+		CreateState();
+}
+
+void BehaviourTree::Update(float deltaTime, DeferredActions* deferred)
 {
-	m_RootNode.m_Context = new std::unordered_map<std::string, BehaviourNode::ContextData>();
+	if (!m_State)
+		CreateState();
+	else if (IsSleeping())
+	{
+		m_SleptTime += deltaTime;
+		return;
+	}
+
+	ExecutionContext previous = BehaviourNode::s_Execution;
+	BehaviourNode::s_Execution = { &m_Blackboard, m_State, deltaTime + m_SleptTime };
+	BehaviourNode::s_Execution.Deferred = deferred;
+	m_SleptTime = 0.0f;
+	m_Definition->GetCompiledTree().Execute(m_Parent, m_State, m_Progress);
+	BehaviourNode::s_Execution = previous;
+
+	m_SleepVersion = m_Blackboard.GetVersion();
 }
 
-BehaviourTree::~BehaviourTree() { Clear(); }
+void BehaviourTree::DebugDraw()
+{
+	if (!m_State)
+		return;
 
-void BehaviourTree::Clear() { delete m_RootNode.m_Context; }
-void BehaviourTree::Update() { m_RootNode.Execute(m_Parent); }
-void BehaviourTree::DebugDraw() { m_RootNode.OnDebugDraw(m_Parent); }
\ No newline at end of file
+	ExecutionContext previous = BehaviourNode::s_Execution;
+	BehaviourNode::s_Execution = { &m_Blackboard, m_State };
+	m_Definition->GetCompiledTree().DebugDraw(m_Parent, m_State);
+	BehaviourNode::s_Execution = previous;
+}
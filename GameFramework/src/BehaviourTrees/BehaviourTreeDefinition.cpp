@@ -0,0 +1,61 @@
+#include <Framework/BehaviourTrees/BehaviourProfiler.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeDefinition.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+BehaviourTreeDefinition::BehaviourTreeDefinition(string name) :
+	m_Arena(), m_RootNode(), m_CompiledTree(), m_StateSize(0), m_StatefulNodes(), m_Finalised(false), m_Name(name)
+{
+	m_RootNode.m_Arena = &m_Arena;
+	BehaviourProfiler::RegisterTree(m_Name, &m_RootNode);
+}
+
+BehaviourTreeDefinition::~BehaviourTreeDefinition() { BehaviourProfiler::UnregisterTree(&m_RootNode); }
+
+void BehaviourTreeDefinition::Finalise()
+{
+	if (m_Finalised)
+		return;
+
+	m_StateSize = 0;
+	m_StatefulNodes.clear();
+	LayoutState(&m_RootNode);
+
+	m_CompiledTree.Compile(&m_RootNode);
+	m_Finalised = true;
+}
+
+void BehaviourTreeDefinition::LayoutState(BehaviourNode* node)
+{
+	size_t size = node->GetStateSize();
+	if (size > 0)
+	{
+		// State block is allocated with default new alignment
+		size_t alignment = node->GetStateAlignment();
+		assert(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+		m_StateSize = (m_StateSize + alignment - 1) & ~(alignment - 1);
+		node->m_StateOffset = (unsigned int)m_StateSize;
+		m_StateSize += size;
+		m_StatefulNodes.emplace_back(node);
+	}
+
+	vector<BehaviourNode*> children;
+	node->GetChildNodes(children);
+	for (BehaviourNode* child : children)
+		LayoutState(child);
+}
+
+void BehaviourTreeDefinition::ConstructState(char* state)
+{
+	for (BehaviourNode* node : m_StatefulNodes)
+		node->ConstructState(state + node->m_StateOffset);
+}
+
+void BehaviourTreeDefinition::DestructState(char* state)
+{
+	for (BehaviourNode* node : m_StatefulNodes)
+		node->DestructState(state + node->m_StateOffset);
+}
@@ -0,0 +1,667 @@
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <raylib.h>
+#include <unordered_map>
+#include <Framework/Logger.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeLoader.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+static const char* LoaderName = "BehaviourTreeLoader";
+
+// Include depth before a file is assumed to include itself
+static const size_t MaxIncludeDepth = 16;
+
+/// --- TEXT --- ///
+struct TreeToken
+{
+	enum class Kind { End, Word, String, Number, Symbol };
+
+	Kind Type = Kind::End;
+	string Text;
+	double Number = 0.0;
+	int Line = 0;
+};
+
+// Splits text format into tokens, see BehaviourTreeLoader
+static bool Tokenize(const string& source, const string& path, vector<TreeToken>& output)
+{
+	size_t i = 0;
+	int line = 1;
+	while (i < source.size())
+	{
+		char c = source[i];
+		if (c == '\n')
+		{
+			line++;
+			i++;
+			continue;
+		}
+		if (isspace((unsigned char)c))
+		{
+			i++;
+			continue;
+		}
+		if (c == '#')
+		{
+			while (i < source.size() && source[i] != '\n')
+				i++;
+			continue;
+		}
+
+		TreeToken token;
+		token.Line = line;
+		if (isalpha((unsigned char)c) || c == '_')
+		{
+			size_t start = i;
+			while (i < source.size() && (isalnum((unsigned char)source[i]) || source[i] == '_'))
+				i++;
+			token.Type = TreeToken::Kind::Word;
+			token.Text = source.substr(start, i - start);
+		}
+		else if (isdigit((unsigned char)c) || c == '-' || c == '+' || c == '.')
+		{
+			const char* start = source.c_str() + i;
+			char* end = nullptr;
+			token.Type = TreeToken::Kind::Number;
+			token.Number = strtod(start, &end);
+			if (end == start)
+			{
+				FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s:%d: Invalid number", path.c_str(), line);
+				return false;
+			}
+			i += end - start;
+		}
+		else if (c == '"')
+		{
+			token.Type = TreeToken::Kind::String;
+			for (i++; i < source.size() && source[i] != '"'; i++)
+			{
+				if (source[i] == '\n')
+					break;
+				if (source[i] == '\\' && i + 1 < source.size())
+				{
+					i++;
+					token.Text += source[i] == 'n' ? '\n' : source[i];
+				}
+				else
+					token.Text += source[i];
+			}
+			if (i >= source.size() || source[i] != '"')
+			{
+				FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s:%d: Unterminated string", path.c_str(), line);
+				return false;
+			}
+			i++;
+		}
+		else if (strchr("{}[]=,", c))
+		{
+			token.Type = TreeToken::Kind::Symbol;
+			token.Text = string(1, c);
+			i++;
+		}
+		else
+		{
+			FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s:%d: Unexpected character '%c'", path.c_str(), line, c);
+			return false;
+		}
+		output.emplace_back(move(token));
+	}
+
+	TreeToken end;
+	end.Line = line;
+	output.emplace_back(end);
+	return true;
+}
+
+// Recursive descent over tokens, includes are left as nodes for the loader to expand
+class TreeParser
+{
+	const vector<TreeToken>& m_Tokens;
+	const string& m_Path;
+	size_t m_Index = 0;
+
+	const TreeToken& Peek(size_t offset = 0) { return m_Tokens[min(m_Index + offset, m_Tokens.size() - 1)]; }
+	bool IsSymbol(const TreeToken& token, char symbol) { return token.Type == TreeToken::Kind::Symbol && token.Text[0] == symbol; }
+
+	bool Error(const TreeToken& token, const char* message)
+	{
+		FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s:%d: %s", m_Path.c_str(), token.Line, message);
+		return false;
+	}
+
+	bool ParseValue(NodeValue& output)
+	{
+		const TreeToken& token = m_Tokens[m_Index++];
+		switch (token.Type)
+		{
+		case TreeToken::Kind::Number:
+			output.ValueType = NodeValue::Type::Number;
+			output.Number = token.Number;
+			return true;
+		case TreeToken::Kind::String:
+			output.ValueType = NodeValue::Type::String;
+			output.Text = token.Text;
+			return true;
+		case TreeToken::Kind::Word:
+			if (token.Text == "true" || token.Text == "false")
+			{
+				output.ValueType = NodeValue::Type::Boolean;
+				output.Number = token.Text == "true" ? 1.0 : 0.0;
+			}
+			else
+			{
+				output.ValueType = NodeValue::Type::String;
+				output.Text = token.Text;
+			}
+			return true;
+		default:
+			break;
+		}
+
+		if (!IsSymbol(token, '['))
+			return Error(token, "Expected value");
+
+		output.ValueType = NodeValue::Type::List;
+		while (!IsSymbol(Peek(), ']'))
+		{
+			output.Items.emplace_back();
+			if (!ParseValue(output.Items.back()))
+				return false;
+			if (IsSymbol(Peek(), ','))
+				m_Index++;
+			else if (!IsSymbol(Peek(), ']'))
+				return Error(Peek(), "Expected ',' or ']'");
+		}
+		m_Index++;
+		return true;
+	}
+
+	bool ParseNode(NodeDescription& output)
+	{
+		const TreeToken& type = m_Tokens[m_Index++];
+		if (type.Type != TreeToken::Kind::Word)
+			return Error(type, "Expected node type");
+		output.Type = type.Text;
+
+		// Properties are 'Name=Value', anything else on the same level is a sibling node
+		while (Peek().Type == TreeToken::Kind::Word && IsSymbol(Peek(1), '='))
+		{
+			string name = m_Tokens[m_Index].Text;
+			m_Index += 2;
+			output.Properties.emplace_back(name, NodeValue());
+			if (!ParseValue(output.Properties.back().second))
+				return false;
+		}
+
+		if (!IsSymbol(Peek(), '{'))
+			return true;
+		m_Index++;
+		if (!ParseNodes(output.Children, true))
+			return false;
+		m_Index++; // Closing brace
+		return true;
+	}
+
+public:
+	TreeParser(const vector<TreeToken>& tokens, const string& path) : m_Tokens(tokens), m_Path(path) { }
+
+	bool ParseNodes(vector<NodeDescription>& output, bool nested)
+	{
+		while (true)
+		{
+			const TreeToken& token = Peek();
+			if (token.Type == TreeToken::Kind::End)
+				return nested ? Error(token, "Expected '}'") : true;
+			if (IsSymbol(token, '}'))
+				return nested ? true : Error(token, "Unexpected '}'");
+
+			output.emplace_back();
+			if (!ParseNode(output.back()))
+				return false;
+		}
+	}
+};
+
+static string GetDirectory(const string& path)
+{
+	size_t separator = path.find_last_of("/\\");
+	return separator == string::npos ? "" : path.substr(0, separator + 1);
+}
+
+// Replaces Include nodes with the nodes of the file they name
+static bool ExpandIncludes(vector<NodeDescription>& nodes, const string& path,
+	const function<bool(const string&, vector<NodeDescription>&)>& parse)
+{
+	size_t i = 0;
+	while (i < nodes.size())
+	{
+		if (nodes[i].Type != "Include")
+		{
+			if (!ExpandIncludes(nodes[i].Children, path, parse))
+				return false;
+			i++;
+			continue;
+		}
+
+		string includePath;
+		for (auto& property : nodes[i].Properties)
+			if (property.first == "Path")
+				property.second.Read(includePath);
+		if (includePath.empty())
+		{
+			FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s: Include needs a Path", path.c_str());
+			return false;
+		}
+
+		vector<NodeDescription> included;
+		if (!parse(GetDirectory(path) + includePath, included))
+			return false;
+
+		nodes.erase(nodes.begin() + i);
+		nodes.insert(nodes.begin() + i, make_move_iterator(included.begin()), make_move_iterator(included.end()));
+		i += included.size();
+	}
+	return true;
+}
+
+bool BehaviourTreeLoader::ParseFile(const string& path, TreeDescription& output, vector<string>& includeStack)
+{
+	if (includeStack.size() >= MaxIncludeDepth || find(includeStack.begin(), includeStack.end(), path) != includeStack.end())
+	{
+		FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s: Recursive include", path.c_str());
+		return false;
+	}
+
+	ifstream file(path);
+	if (!file)
+	{
+		FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s: Could not open file", path.c_str());
+		return false;
+	}
+	stringstream source;
+	source << file.rdbuf();
+
+	vector<TreeToken> tokens;
+	if (!Tokenize(source.str(), path, tokens))
+		return false;
+
+	vector<NodeDescription> nodes;
+	if (!TreeParser(tokens, path).ParseNodes(nodes, false))
+		return false;
+
+	output.Sources.emplace_back(path, GetFileModTime(path.c_str()));
+
+	includeStack.emplace_back(path);
+	bool success = ExpandIncludes(nodes, path, [&](const string& includePath, vector<NodeDescription>& included)
+	{
+		TreeDescription description;
+		if (!ParseFile(includePath, description, includeStack))
+			return false;
+		included = move(description.Nodes);
+		output.Sources.insert(output.Sources.end(), description.Sources.begin(), description.Sources.end());
+		return true;
+	});
+	includeStack.pop_back();
+
+	output.Nodes.insert(output.Nodes.end(), make_move_iterator(nodes.begin()), make_move_iterator(nodes.end()));
+	return success;
+}
+
+bool BehaviourTreeLoader::ParseText(const string& path, TreeDescription& output)
+{
+	vector<string> includeStack;
+	return ParseFile(path, output, includeStack);
+}
+
+/// --- BINARY --- ///
+// Layout, all integers little endian:
+//	"BTB" Version(u8)
+//	SourceCount(u32) [Path(string) ModTime(i64)]
+//	StringCount(u32) [Length(u32) Characters]
+//	NodeCount(u32) [Node]
+// Node is Type(u32 string index) PropertyCount(u32) [Name(u32) Value] ChildCount(u32) [Node], in preorder.
+// Value is Type(u8) followed by Number(f64), String(u32), Boolean(u8) or Count(u32) [Value]
+static const char BinaryMagic[3] = { 'B', 'T', 'B' };
+static const uint8_t BinaryVersion = 1;
+
+class BinaryWriter
+{
+	unordered_map<string, uint32_t> m_StringIndices;
+
+public:
+	string Data;
+	vector<string> Strings;
+
+	template<typename T>
+	void Write(T value) { Data.append((const char*)&value, sizeof(T)); }
+
+	void WriteString(const string& value)
+	{
+		Write((uint32_t)value.size());
+		Data.append(value);
+	}
+
+	void WriteStringIndex(const string& value)
+	{
+		auto it = m_StringIndices.find(value);
+		if (it == m_StringIndices.end())
+		{
+			it = m_StringIndices.emplace(value, (uint32_t)Strings.size()).first;
+			Strings.emplace_back(value);
+		}
+		Write(it->second);
+	}
+
+	void WriteValue(const NodeValue& value)
+	{
+		Write((uint8_t)value.ValueType);
+		switch (value.ValueType)
+		{
+		case NodeValue::Type::Number: Write(value.Number); break;
+		case NodeValue::Type::String: WriteStringIndex(value.Text); break;
+		case NodeValue::Type::Boolean: Write((uint8_t)(value.Number != 0.0)); break;
+		case NodeValue::Type::List:
+			Write((uint32_t)value.Items.size());
+			for (const NodeValue& item : value.Items)
+				WriteValue(item);
+			break;
+		}
+	}
+
+	void WriteNode(const NodeDescription& node)
+	{
+		WriteStringIndex(node.Type);
+		Write((uint32_t)node.Properties.size());
+		for (auto& property : node.Properties)
+		{
+			WriteStringIndex(property.first);
+			WriteValue(property.second);
+		}
+		Write((uint32_t)node.Children.size());
+		for (const NodeDescription& child : node.Children)
+			WriteNode(child);
+	}
+};
+
+// Bounds checked reads, any read past the end marks the reader as failed
+class BinaryReader
+{
+	const string& m_Data;
+	size_t m_Position = 0;
+
+public:
+	bool Failed = false;
+	vector<string> Strings;
+
+	BinaryReader(const string& data) : m_Data(data) { }
+
+	template<typename T>
+	T Read()
+	{
+		T value = T();
+		if (Failed || m_Data.size() - m_Position < sizeof(T))
+		{
+			Failed = true;
+			return value;
+		}
+		memcpy(&value, m_Data.data() + m_Position, sizeof(T));
+		m_Position += sizeof(T);
+		return value;
+	}
+
+	string ReadString()
+	{
+		uint32_t length = Read<uint32_t>();
+		if (Failed || m_Data.size() - m_Position < length)
+		{
+			Failed = true;
+			return "";
+		}
+		string value = m_Data.substr(m_Position, length);
+		m_Position += length;
+		return value;
+	}
+
+	const string& ReadStringIndex()
+	{
+		static const string Empty;
+		uint32_t index = Read<uint32_t>();
+		if (Failed || index >= Strings.size())
+		{
+			Failed = true;
+			return Empty;
+		}
+		return Strings[index];
+	}
+
+	// Counts are checked against remaining data so a corrupt file can't cause a huge allocation
+	uint32_t ReadCount()
+	{
+		uint32_t count = Read<uint32_t>();
+		if (count > m_Data.size() - m_Position)
+			Failed = true;
+		return Failed ? 0 : count;
+	}
+
+	bool ReadValue(NodeValue& value)
+	{
+		value.ValueType = (NodeValue::Type)Read<uint8_t>();
+		switch (value.ValueType)
+		{
+		case NodeValue::Type::Number: value.Number = Read<double>(); break;
+		case NodeValue::Type::String: value.Text = ReadStringIndex(); break;
+		case NodeValue::Type::Boolean: value.Number = Read<uint8_t>() ? 1.0 : 0.0; break;
+		case NodeValue::Type::List:
+			value.Items.resize(ReadCount());
+			for (NodeValue& item : value.Items)
+				if (!ReadValue(item))
+					break;
+			break;
+		default: Failed = true; break;
+		}
+		return !Failed;
+	}
+
+	bool ReadNode(NodeDescription& node, unsigned int depth)
+	{
+		if (depth > 1024)
+			Failed = true;
+
+		node.Type = ReadStringIndex();
+		node.Properties.resize(ReadCount());
+		for (auto& property : node.Properties)
+		{
+			property.first = ReadStringIndex();
+			if (!ReadValue(property.second))
+				return false;
+		}
+		node.Children.resize(ReadCount());
+		for (NodeDescription& child : node.Children)
+			if (!ReadNode(child, depth + 1))
+				return false;
+		return !Failed;
+	}
+};
+
+bool BehaviourTreeLoader::WriteBinary(const string& path, const TreeDescription& description)
+{
+	BinaryWriter nodes;
+	nodes.Write((uint32_t)description.Nodes.size());
+	for (const NodeDescription& node : description.Nodes)
+		nodes.WriteNode(node);
+
+	BinaryWriter header;
+	header.Data.append(BinaryMagic, sizeof(BinaryMagic));
+	header.Write(BinaryVersion);
+	header.Write((uint32_t)description.Sources.size());
+	for (auto& source : description.Sources)
+	{
+		header.WriteString(source.first);
+		header.Write((int64_t)source.second);
+	}
+	header.Write((uint32_t)nodes.Strings.size());
+	for (const string& value : nodes.Strings)
+		header.WriteString(value);
+
+	ofstream file(path, ios::binary);
+	if (!file)
+		return false;
+	file.write(header.Data.data(), header.Data.size());
+	file.write(nodes.Data.data(), nodes.Data.size());
+	return (bool)file;
+}
+
+bool BehaviourTreeLoader::ReadBinary(const string& path, TreeDescription& output)
+{
+	ifstream file(path, ios::binary);
+	if (!file)
+		return false;
+	stringstream stream;
+	stream << file.rdbuf();
+	string data = stream.str();
+
+	if (data.size() < sizeof(BinaryMagic) + 1 || memcmp(data.data(), BinaryMagic, sizeof(BinaryMagic)) != 0 ||
+		(uint8_t)data[sizeof(BinaryMagic)] != BinaryVersion)
+		return false; // Not a tree file or from another version, text is loaded instead
+
+	BinaryReader reader(data);
+	for (size_t i = 0; i <= sizeof(BinaryMagic); i++)
+		reader.Read<uint8_t>();
+
+	TreeDescription description;
+	description.Sources.resize(reader.ReadCount());
+	for (auto& source : description.Sources)
+	{
+		source.first = reader.ReadString();
+		source.second = (long)reader.Read<int64_t>();
+	}
+	reader.Strings.resize(reader.ReadCount());
+	for (string& value : reader.Strings)
+		value = reader.ReadString();
+
+	description.Nodes.resize(reader.ReadCount());
+	for (NodeDescription& node : description.Nodes)
+		if (!reader.ReadNode(node, 0))
+			break;
+
+	if (reader.Failed)
+	{
+		FRAMEWORK_LOG_WARNING(Logger::NoAgent, LoaderName, "%s: Corrupt binary tree", path.c_str());
+		return false;
+	}
+	output = move(description);
+	return true;
+}
+
+static bool AreSourcesCurrent(const TreeDescription& description)
+{
+	for (auto& source : description.Sources)
+		if (!FileExists(source.first.c_str()) || GetFileModTime(source.first.c_str()) != source.second)
+			return false;
+	return !description.Sources.empty();
+}
+
+bool BehaviourTreeLoader::IsBinaryCurrent(const string& path)
+{
+	TreeDescription description;
+	return ReadBinary(path, description) && AreSourcesCurrent(description);
+}
+
+/// --- INSTANTIATION --- ///
+bool BehaviourTreeLoader::Instantiate(const NodeDescription& description, BehaviourNode* parent, const string& path)
+{
+#ifdef NDEBUG
+	for (auto& property : description.Properties)
+	{
+		bool debugOnly = false;
+		if (property.first == "DebugOnly" && property.second.Read(debugOnly) && debugOnly)
+			return true;
+	}
+#endif
+
+	NodeRegistry::NodeType* type = NodeRegistry::Find(description.Type);
+	if (!type)
+	{
+		FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s: Unknown node type '%s'", path.c_str(), description.Type.c_str());
+		return false;
+	}
+
+	BehaviourNode* node = type->Create(parent);
+	if (!node)
+	{
+		FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s: %s can't have %s as another child",
+			path.c_str(), parent->GetName().c_str(), description.Type.c_str());
+		return false;
+	}
+
+	// Keep going after an error so every problem in the file is reported at once
+	bool success = true;
+	for (auto& property : description.Properties)
+	{
+		const string& name = property.first;
+		if (name == "DebugOnly")
+			continue;
+
+		bool valid = false;
+		if (name == "Label")
+			valid = property.second.Read(node->Label);
+		else
+		{
+			auto setter = type->Properties.find(name);
+			if (setter == type->Properties.end())
+			{
+				FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s: %s has no property '%s'",
+					path.c_str(), description.Type.c_str(), name.c_str());
+				success = false;
+				continue;
+			}
+			valid = setter->second(node, property.second);
+		}
+
+		if (!valid)
+		{
+			FRAMEWORK_LOG_ERROR(Logger::NoAgent, LoaderName, "%s: Invalid value for %s.%s%s%s", path.c_str(), description.Type.c_str(),
+				name.c_str(), property.second.Text.empty() ? "" : " - ", property.second.Text.c_str());
+			success = false;
+		}
+	}
+
+	for (const NodeDescription& child : description.Children)
+		success &= Instantiate(child, node, path);
+	return success;
+}
+
+bool BehaviourTreeLoader::Instantiate(const TreeDescription& description, BehaviourTreeDefinition& definition, const string& path)
+{
+	assert(!definition.IsFinalised()); // Nodes can't be added once agents are using definition
+
+	bool success = true;
+	for (const NodeDescription& node : description.Nodes)
+		success &= Instantiate(node, definition.Root(), path);
+	return success;
+}
+
+bool BehaviourTreeLoader::Load(const string& path, BehaviourTreeDefinition& definition)
+{
+	string binaryPath = path + "b";
+
+	TreeDescription description;
+	if (!ReadBinary(binaryPath, description) || !AreSourcesCurrent(description))
+	{
+		description = TreeDescription();
+		if (!ParseText(path, description))
+			return false;
+
+		// Cache is optional, e.g. assets may be read-only
+		if (!WriteBinary(binaryPath, description))
+			FRAMEWORK_LOG_DEBUG(Logger::NoAgent, LoaderName, "%s: Could not write binary cache", binaryPath.c_str());
+	}
+
+	return Instantiate(description, definition, path);
+}
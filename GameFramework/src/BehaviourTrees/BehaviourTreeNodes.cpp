@@ -1,148 +1,240 @@
-#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <typeinfo>
+#include <Framework/Logger.hpp>
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
+#include <Framework/BehaviourTrees/BehaviourProfiler.hpp>
 #include <Framework/BehaviourTrees/BehaviourTreeNodes.hpp>
 
 using namespace std;
 using namespace Framework;
 using namespace Framework::BT;
 
-void BehaviourNode::ClearContext() { m_Context->clear(); }
-void BehaviourNode::ClearContext(string name) { m_Context->erase(name); }
-bool BehaviourNode::ContextExists(string name) { return m_Context->find(name) != m_Context->end(); }
+thread_local ExecutionContext BehaviourNode::s_Execution;
 
-void BehaviourNode::SetContext(string name, int value) { SetContext(name, (unsigned long long)value); }
-void BehaviourNode::SetContext(string name, long value) { SetContext(name, (unsigned long long)value); }
-void BehaviourNode::SetContext(string name, short value) { SetContext(name, (unsigned long long)value); }
-void BehaviourNode::SetContext(string name, long long value) { SetContext(name, (unsigned long long)value); }
-void BehaviourNode::SetContext(string name, unsigned int value) { SetContext(name, (unsigned long long)value); }
-void BehaviourNode::SetContext(string name, unsigned long value) { SetContext(name, (unsigned long long)value); }
-void BehaviourNode::SetContext(string name, unsigned short value) { SetContext(name, (unsigned long long)value); }
-void BehaviourNode::SetContext(string name, unsigned long long value)
+void BehaviourNode::DestroyChild(BehaviourNode* child)
 {
-	if (!ContextExists(name))
-		m_Context->emplace(name, ContextData());
+	if (!child)
+		return;
+	if (m_Arena)
+		child->~BehaviourNode();
+	else
+		delete child;
+}
 
-	ContextData* data = &m_Context->at(name);
-	data->Type = ContextDataType::Integer;
-	data->Data = make_any<unsigned long long>(value);
+BehaviourResult BehaviourNode::Tick(GameObject* go)
+{
+	if (!BehaviourProfiler::IsEnabled())
+		return Execute(go);
+
+	BehaviourProfiler::Begin(this);
+	BehaviourResult result = Execute(go);
+	BehaviourProfiler::End(this, result);
+	return result;
 }
 
-void BehaviourNode::SetContext(string name, std::string value)
+void BehaviourNode::SleepUntil(double time)
 {
-	if (!ContextExists(name))
-		m_Context->emplace(name, ContextData());
+	s_Execution.WakeTime = time;
+	s_Execution.SleepNode = this;
+}
 
-	ContextData* data = &m_Context->at(name);
-	data->Type = ContextDataType::String;
-	data->Data = make_any<string>(value);
+void BehaviourNode::Defer(function<void()> action)
+{
+	if (s_Execution.Deferred)
+		s_Execution.Deferred->emplace_back(move(action));
+	else
+		action();
 }
 
-void BehaviourNode::SetContext(string name, float value) { SetContext(name, double(value)); }
-void BehaviourNode::SetContext(string name, double value)
+void BehaviourNode::ResetState(BehaviourNode* node)
 {
-	if (!ContextExists(name))
-		m_Context->emplace(name, ContextData());
+	if (node->GetStateSize() > 0)
+	{
+		void* state = s_Execution.State + node->m_StateOffset;
+		node->DestructState(state);
+		node->ConstructState(state);
+	}
 
-	ContextData* data = &m_Context->at(name);
-	data->Type = ContextDataType::Decimal;
-	data->Data = make_any<double>(value);
+	vector<BehaviourNode*> children;
+	node->GetChildNodes(children);
+	for (BehaviourNode* child : children)
+		ResetState(child);
 }
 
+void BehaviourNode::ClearContext() { s_Execution.Context->Clear(); }
+void BehaviourNode::ClearContext(const string& name) { s_Execution.Context->Clear(name); }
+bool BehaviourNode::ContextExists(const string& name) { return s_Execution.Context->Has(name); }
+
 /// --- EVALUATOR --- ///
+Evaluator::~Evaluator()
+{
+	DestroyChild(m_True);
+	DestroyChild(m_False);
+}
+
+void Evaluator::GetChildNodes(vector<BehaviourNode*>& children)
+{
+	if (m_True)
+		children.emplace_back(m_True);
+	if (m_False)
+		children.emplace_back(m_False);
+}
+
 BehaviourResult Evaluator::Execute(GameObject* go)
 {
 	if (!go || !Function)
 		return BehaviourResult::Failure;
 	if (Function(go, this))
-		return m_True ? m_True->Execute(go) : BehaviourResult::Failure;
+		return m_True ? m_True->Tick(go) : BehaviourResult::Failure;
 	else
-		return m_False ? m_False->Execute(go) : BehaviourResult::Failure;
+		return m_False ? m_False->Tick(go) : BehaviourResult::Failure;
 }
 
 /// --- CONDITIONAL --- ///
+Conditional::~Conditional() { DestroyChild(m_Child); }
+
+void Conditional::GetChildNodes(vector<BehaviourNode*>& children)
+{
+	if (m_Child)
+		children.emplace_back(m_Child);
+}
+
+bool Conditional::Watch(const string& keyName)
+{
+	int slot = BlackboardRegistry::Find(keyName);
+	if (slot < 0)
+		return false;
+	m_WatchedSlots.emplace_back((unsigned int)slot);
+	return true;
+}
+
+unsigned long long Conditional::GetWatchedVersion()
+{
+	unsigned long long version = 0;
+	for (unsigned int slot : m_WatchedSlots)
+		version += s_Execution.Context->GetVersion(slot);
+	return version;
+}
+
+bool Conditional::Evaluate(GameObject* go)
+{
+	if (!Function)
+		return false;
+	if (!IsEventDriven())
+		return Function(go, this);
+
+	ConditionalState& state = GetState();
+	double time = GetTime();
+	unsigned long long version = GetWatchedVersion();
+	if (state.Cached && state.WatchedVersion == version &&
+		(RecheckInterval <= 0.0f || time < state.NextCheckTime))
+		return state.Result;
+
+	state.Result = Function(go, this);
+	state.Cached = true;
+	state.WatchedVersion = version;
+	state.NextCheckTime = time + RecheckInterval;
+	return state.Result;
+}
+
+double Conditional::GetNextCheckTime()
+{
+	if (!IsEventDriven())
+		return 0.0;
+
+	ConditionalState& state = GetState();
+	if (!state.Cached)
+		return 0.0;
+	return RecheckInterval > 0.0f ? state.NextCheckTime : numeric_limits<double>::infinity();
+}
+
 BehaviourResult Conditional::Execute(GameObject* go)
 {
 	if (!go || !Function)
 		return BehaviourResult::Failure;
-	return Function(go, this) ? (m_Child ? m_Child->Execute(go) : BehaviourResult::Success) : BehaviourResult::Failure;
+	return Evaluate(go) ? (m_Child ? m_Child->Tick(go) : BehaviourResult::Success) : BehaviourResult::Failure;
 }
 
 /// --- COMPOSITE --- ///
 Composite::~Composite()
 {
 	for (BehaviourNode* child : m_Children)
-		delete child;
+		DestroyChild(child);
 	m_Children.clear();
 	m_Children.shrink_to_fit();
 }
 
 void Composite::OnDebugDraw(GameObject* go)
 {
-	auto children = GetChildren();
+	auto& children = GetChildren();
+	int pendingChildIndex = GetState();
 	if (children.size() == 0)
 		return;
-	if (PendingChildIndex < 0 || PendingChildIndex >= children.size())
-		PendingChildIndex = 0;
-	GetChildren()[PendingChildIndex]->OnDebugDraw(go);
+	if (pendingChildIndex < 0 || pendingChildIndex >= children.size())
+		pendingChildIndex = 0;
+	children[pendingChildIndex]->OnDebugDraw(go);
 }
 
+void Composite::GetChildNodes(vector<BehaviourNode*>& children) { children.insert(children.end(), m_Children.begin(), m_Children.end()); }
+
 vector<BehaviourNode*>& Composite::GetChildren() { return m_Children; }
 
 /// --- SEQUENCE --- ///
 BehaviourResult Sequence::Execute(GameObject* go)
 {
-	auto children = GetChildren();
+	auto& children = GetChildren();
+	int& pendingChildIndex = GetState();
 	if (!go || children.size() == 0)
 		return BehaviourResult::Failure;
-	if (PendingChildIndex < 0 || PendingChildIndex >= children.size())
-		PendingChildIndex = 0;
-	BehaviourNode* child = children[PendingChildIndex];
+	if (pendingChildIndex < 0 || pendingChildIndex >= children.size())
+		pendingChildIndex = 0;
+	BehaviourNode* child = children[pendingChildIndex];
 
 	while (child)
 	{
-		SetContext("SequenceIndex", PendingChildIndex);
-		auto result = child->Execute(go);
+		auto result = child->Tick(go);
 		switch (result)
 		{
-		case BehaviourResult::Failure: PendingChildIndex = 0;
+		case BehaviourResult::Failure: pendingChildIndex = 0;
 		case BehaviourResult::Pending: return result;
 		case BehaviourResult::Success:
-			if (++PendingChildIndex >= children.size())
+			if (++pendingChildIndex >= children.size())
 			{
 				child = nullptr;
 				break;
 			}
-			child = children[PendingChildIndex];
+			child = children[pendingChildIndex];
 			break;
 		}
 	}
-	PendingChildIndex = 0;
+	pendingChildIndex = 0;
 	return BehaviourResult::Success;
 }
 
 BehaviourResult RandomSequence::Execute(GameObject* go)
 {
 	auto children = GetChildren();
+	int& pendingChildIndex = GetState();
 	if (!go || children.size() == 0)
 		return BehaviourResult::Failure;
-	if (PendingChildIndex < 0)
-		PendingChildIndex = rand() % children.size();
-	BehaviourNode* child = children[PendingChildIndex];
+	if (pendingChildIndex < 0)
+		pendingChildIndex = rand() % children.size();
+	BehaviourNode* child = children[pendingChildIndex];
 
-	unsigned int sequenceIndex = 0;
 	while (child)
 	{
-		SetContext("SequenceIndex", sequenceIndex++);
-		auto result = child->Execute(go);
-		children.erase(children.begin() + PendingChildIndex);
+		auto result = child->Tick(go);
+		children.erase(children.begin() + pendingChildIndex);
 		switch (result)
 		{
-		case BehaviourResult::Failure: PendingChildIndex = 0;
+		case BehaviourResult::Failure: pendingChildIndex = 0;
 		case BehaviourResult::Pending: return result;
 		case BehaviourResult::Success:
 			if (children.size() == 0)
 				return result;
-			PendingChildIndex = rand() % children.size();
-			child = children[PendingChildIndex];
+			pendingChildIndex = rand() % children.size();
+			child = children[pendingChildIndex];
 			break;
 		}
 	}
@@ -152,61 +244,169 @@ BehaviourResult RandomSequence::Execute(GameObject* go)
 /// --- SELECTOR --- ///
 BehaviourResult Selector::Execute(GameObject* go)
 {
-	auto children = GetChildren();
+	auto& children = GetChildren();
+	int& pendingChildIndex = GetState();
 	if (!go || children.size() == 0)
 		return BehaviourResult::Failure;
-	if (PendingChildIndex < 0 || PendingChildIndex >= children.size())
-		PendingChildIndex = 0;
-	BehaviourNode* child = children[PendingChildIndex];
+	if (pendingChildIndex < 0 || pendingChildIndex >= children.size())
+		pendingChildIndex = 0;
+	BehaviourNode* child = children[pendingChildIndex];
 
 	while (child)
 	{
-		SetContext("SelectorIndex", PendingChildIndex);
-		auto result = child->Execute(go);
+		auto result = child->Tick(go);
 		switch (result)
 		{
 		case BehaviourResult::Pending: return result;
-		case BehaviourResult::Success: PendingChildIndex = -1; return result;
+		case BehaviourResult::Success: pendingChildIndex = -1; return result;
 		case BehaviourResult::Failure:
-			if (++PendingChildIndex >= children.size())
+			if (++pendingChildIndex >= children.size())
 			{
 				child = nullptr;
 				break;
 			}
-			child = children[PendingChildIndex];
+			child = children[pendingChildIndex];
+			break;
+		}
+	}
+
+	pendingChildIndex = 0;
+	return BehaviourResult::Failure;
+}
+
+Conditional* ReactiveSelector::GetGuard(BehaviourNode* child)
+{
+	if (Conditional* conditional = dynamic_cast<Conditional*>(child))
+		return conditional;
+
+	Sequence* sequence = dynamic_cast<Sequence*>(child);
+	if (!sequence || sequence->GetChildren().empty())
+		return nullptr;
+	return dynamic_cast<Conditional*>(sequence->GetChildren()[0]);
+}
+
+BehaviourResult ReactiveSelector::Execute(GameObject* go)
+{
+	auto& children = GetChildren();
+	int& pendingChildIndex = GetState();
+
+	// Switch to higher priority child if its guard now passes
+	if (go && pendingChildIndex > 0 && pendingChildIndex < children.size())
+	{
+		for (int i = 0; i < pendingChildIndex; i++)
+		{
+			Conditional* guard = GetGuard(children[i]);
+			if (!guard || !guard->Evaluate(go))
+				continue;
+
+			ResetState(children[pendingChildIndex]);
+			pendingChildIndex = i;
 			break;
 		}
 	}
 
-	PendingChildIndex = 0;
+	return Selector::Execute(go);
+}
+
+unsigned int UtilitySelector::Rank(GameObject* go, int committed, int* order)
+{
+	auto& children = GetChildren();
+	int childCount = min((int)children.size(), (int)MaxChildren);
+	float scores[MaxChildren];
+	unsigned int count = 0;
+	for (int i = 0; i < childCount; i++)
+	{
+		float score = i < (int)Scores.size() && Scores[i] ? Scores[i](go, this) : 0.0f;
+		if (score <= 0.0f)
+			continue;
+		if (i == committed)
+			score += Hysteresis;
+
+		// Insertion sort, only moves past lower scores so equal scores keep child order
+		unsigned int slot = count++;
+		for (; slot > 0 && scores[slot - 1] < score; slot--)
+		{
+			scores[slot] = scores[slot - 1];
+			order[slot] = order[slot - 1];
+		}
+		scores[slot] = score;
+		order[slot] = i;
+	}
+	return count;
+}
+
+BehaviourResult UtilitySelector::Execute(GameObject* go)
+{
+	auto& children = GetChildren();
+	UtilitySelectorState& state = GetState();
+	if (!go || children.size() == 0)
+		return BehaviourResult::Failure;
+	if (state.Pending >= (int)children.size())
+		state.Pending = -1;
+
+	// Keep running committed child until scores are due
+	int failed = -1;
+	if (state.Pending >= 0 && GetTime() < state.NextCheckTime)
+	{
+		BehaviourResult result = children[state.Pending]->Tick(go);
+		if (result != BehaviourResult::Failure)
+		{
+			if (result == BehaviourResult::Success)
+				state.Pending = -1;
+			return result;
+		}
+		failed = state.Pending;
+		state.Pending = -1;
+	}
+
+	int order[MaxChildren];
+	unsigned int count = Rank(go, state.Pending, order);
+	state.NextCheckTime = GetTime() + RecheckInterval;
+
+	// Abort committed child when another takes over
+	if (state.Pending >= 0 && (count == 0 || order[0] != state.Pending))
+		ResetState(children[state.Pending]);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		int child = order[i];
+		if (child == failed)
+			continue;
+		BehaviourResult result = children[child]->Tick(go);
+		if (result == BehaviourResult::Failure)
+			continue;
+		state.Pending = result == BehaviourResult::Pending ? child : -1;
+		return result;
+	}
+
+	state.Pending = -1;
 	return BehaviourResult::Failure;
 }
 
 BehaviourResult RandomSelector::Execute(GameObject* go)
 {
 	auto children = GetChildren();
+	int& pendingChildIndex = GetState();
 	if (!go || children.size() == 0)
 		return BehaviourResult::Failure;
-	if (PendingChildIndex < 0)
-		PendingChildIndex = rand() % children.size();
-	BehaviourNode* child = children[PendingChildIndex];
-	children.erase(children.begin() + PendingChildIndex);
+	if (pendingChildIndex < 0)
+		pendingChildIndex = rand() % children.size();
+	BehaviourNode* child = children[pendingChildIndex];
+	children.erase(children.begin() + pendingChildIndex);
 
-	unsigned int selectorIndex = 0;
 	while (child)
 	{
-		SetContext("SelectorIndex", selectorIndex++);
-		auto result = child->Execute(go);
-		children.erase(children.begin() + PendingChildIndex);
+		auto result = child->Tick(go);
+		children.erase(children.begin() + pendingChildIndex);
 		switch (result)
 		{
 		case BehaviourResult::Pending: return result;
-		case BehaviourResult::Success: PendingChildIndex = -1; return result;
+		case BehaviourResult::Success: pendingChildIndex = -1; return result;
 		case BehaviourResult::Failure:
 			if (children.size() == 0)
 				return result;
-			PendingChildIndex = rand() % children.size();
-			child = children[PendingChildIndex];
+			pendingChildIndex = rand() % children.size();
+			child = children[pendingChildIndex];
 			break;
 		}
 	}
@@ -215,7 +415,15 @@ BehaviourResult RandomSelector::Execute(GameObject* go)
 }
 
 /// --- DECORATOR --- ///
-BehaviourNode* Decorator::GetChild() { return m_Child ? m_Child.get() : nullptr; }
+Decorator::~Decorator() { DestroyChild(m_Child); }
+
+void Decorator::GetChildNodes(vector<BehaviourNode*>& children)
+{
+	if (m_Child)
+		children.emplace_back(m_Child);
+}
+
+BehaviourNode* Decorator::GetChild() { return m_Child; }
 
 /// --- INVERSE DECORATOR --- ///
 BehaviourResult Inverse::Execute(GameObject* go)
@@ -223,7 +431,7 @@ BehaviourResult Inverse::Execute(GameObject* go)
 	auto child = GetChild();
 	if (!go || !child)
 		return BehaviourResult::Failure;
-	auto result = child->Execute(go);
+	auto result = child->Tick(go);
 	switch (result)
 	{
 	default:
@@ -235,23 +443,23 @@ BehaviourResult Inverse::Execute(GameObject* go)
 /// --- LOG DECORATOR --- ///
 BehaviourResult Log::Execute(GameObject* go)
 {
-	cout << "[Node] " << Message << endl;
+	FRAMEWORK_LOG_DEBUG(go ? go->GetID() : Logger::NoAgent, Label.empty() ? "Log" : Label.c_str(), "%s", Message.c_str());
 
 	auto child = GetChild();
 	if (go && child)
-		child->Execute(go);
+		child->Tick(go);
 	return BehaviourResult::Success;
 }
 
 /// --- DYNAMIC LOG DECORATOR --- ///
 BehaviourResult DynamicLog::Execute(GameObject* go)
 {
-	if(Message)
-		cout << "[Node] " << Message(go, this) << endl;
+	if (Message)
+		FRAMEWORK_LOG_DEBUG(go ? go->GetID() : Logger::NoAgent, Label.empty() ? "DynamicLog" : Label.c_str(), "%s", Message(go, this).c_str());
 
 	auto child = GetChild();
 	if (go && child)
-		child->Execute(go);
+		child->Tick(go);
 	return BehaviourResult::Success;
 }
 
@@ -261,7 +469,7 @@ BehaviourResult Succeeder::Execute(GameObject* go)
 	auto child = GetChild();
 	auto result = BehaviourResult::Success;
 	if (go && child)
-		result = child->Execute(go);
+		result = child->Tick(go);
 	return result == BehaviourResult::Pending ? result : BehaviourResult::Success;
 }
 
@@ -269,51 +477,53 @@ BehaviourResult Succeeder::Execute(GameObject* go)
 BehaviourResult Repeat::Execute(GameObject* go)
 {
 	auto child = GetChild();
+	unsigned int& repetitions = GetState();
 	BehaviourResult result = BehaviourResult::Failure;
 	if (!go || !child || !Condition)
 		return result;
 
 	bool condition = Condition(go, this);
 	if(condition)
-		result = child->Execute(go);
+		result = child->Tick(go);
 
 	if (SingleFrame)
 	{
 		while (Condition(go, this))
 		{
-			result = child->Execute(go);
-			SetContext("RepeatCount", ++m_Repetitions);
+			result = child->Tick(go);
+			SetContext(Keys::RepeatCount, ++repetitions);
 		}
-		m_Repetitions = 0;
+		repetitions = 0;
 		return result;
 	}
 	else
-		SetContext("RepeatCount", ++m_Repetitions);
+		SetContext(Keys::RepeatCount, ++repetitions);
 
 	if (!condition)
 	{
-		m_Repetitions = 0;
-		ClearContext("RepeatCount");
+		repetitions = 0;
+		ClearContext(Keys::RepeatCount);
 	}
 	return condition ? BehaviourResult::Pending : BehaviourResult::Failure;
 }
 
 /// --- REPEAT TIME --- ///
-void RepeatTime::SetTime(float value) { m_TimeLeft = m_MaxTime = value; }
+void RepeatTime::SetTime(float value) { m_MaxTime = value; }
 
 BehaviourResult RepeatTime::Execute(GameObject* go)
 {
 	auto child = GetChild();
+	float& timeLeft = GetState();
 	if (!child)
 		return BehaviourResult::Failure;
 
-	m_TimeLeft -= GetFrameTime();
-	if (m_TimeLeft > 0)
+	timeLeft -= GetDeltaTime();
+	if (timeLeft > 0)
 	{
-		child->Execute(go);
+		child->Tick(go);
 		return BehaviourResult::Pending;
 	}
-	m_TimeLeft = m_MaxTime;
+	timeLeft = m_MaxTime;
 	return BehaviourResult::Success;
 }
 
@@ -322,19 +532,20 @@ BehaviourResult RepeatTime::Execute(GameObject* go)
 BehaviourResult RepeatCount::Execute(GameObject* go)
 {
 	auto child = GetChild();
+	unsigned int& repetitions = GetState();
 	BehaviourResult result = BehaviourResult::Failure;
 	if (!go || !child)
 		return result;
 
-	SetContext("RepeatCount", m_Repetitions);
+	SetContext(Keys::RepeatCount, repetitions);
 	for (unsigned int i = 0; i < (SingleFrame ? Repetitions : 1u); i++)
 	{
-		result = child->Execute(go);
-		SetContext("RepeatCount", ++m_Repetitions);
+		result = child->Tick(go);
+		SetContext(Keys::RepeatCount, ++repetitions);
 	}
 
-	if (m_Repetitions >= Repetitions)
-		m_Repetitions = 0;
+	if (repetitions >= Repetitions)
+		repetitions = 0;
 	else
 		return BehaviourResult::Pending;
 
@@ -345,25 +556,26 @@ BehaviourResult RepeatCount::Execute(GameObject* go)
 BehaviourResult RepeatUntilFail::Execute(GameObject* go)
 {
 	auto child = GetChild();
+	unsigned int& repetitions = GetState();
 	if (!go || !child)
 		return BehaviourResult::Failure;
 	BehaviourResult result;
 	
-	SetContext("RepeatCount", m_Repetitions);
+	SetContext(Keys::RepeatCount, repetitions);
 
 	if (SingleFrame)
 	{
-		while ((result = child->Execute(go)) != BehaviourResult::Failure)
-			SetContext("RepeatCount", ++m_Repetitions);
+		while ((result = child->Tick(go)) != BehaviourResult::Failure)
+			SetContext(Keys::RepeatCount, ++repetitions);
 		return BehaviourResult::Success;
 	}
 
-	result = child->Execute(go);
+	result = child->Tick(go);
 	if (result == BehaviourResult::Failure)
 	{
-		m_Repetitions = 0;
-		ClearContext("RepeatCount");
-		cout << "[RepeatUntilFail] Failed!" << endl;
+		repetitions = 0;
+		ClearContext(Keys::RepeatCount);
+		FRAMEWORK_LOG_TRACE(go->GetID(), "RepeatUntilFail", "Failed");
 		return result;
 	}
 	return BehaviourResult::Pending;
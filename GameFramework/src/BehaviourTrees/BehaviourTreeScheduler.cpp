@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <Framework/Jobs/JobSystem.hpp>
+#include <Framework/BehaviourTrees/BehaviourProfiler.hpp>
+#include <Framework/BehaviourTrees/BehaviourTreeScheduler.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+BehaviourTreeSchedulerArgs BehaviourTreeScheduler::m_Args;
+vector<BehaviourTreeScheduler::Agent> BehaviourTreeScheduler::m_Agents;
+unordered_map<BehaviourTree*, size_t> BehaviourTreeScheduler::m_AgentIndices;
+vector<BehaviourTreeScheduler::Tick> BehaviourTreeScheduler::m_Ticks;
+vector<DeferredActions> BehaviourTreeScheduler::m_Deferred;
+
+unsigned long long BehaviourTreeScheduler::m_Frame = 0;
+unsigned int BehaviourTreeScheduler::m_NextPhase = 0;
+size_t BehaviourTreeScheduler::m_Cursor = 0;
+unsigned int BehaviourTreeScheduler::m_TicksLastFrame = 0;
+
+void BehaviourTreeScheduler::Init(BehaviourTreeSchedulerArgs args)
+{
+	m_Args = args;
+	m_Frame = 0;
+}
+
+void BehaviourTreeScheduler::Destroy()
+{
+	m_Agents.clear();
+	m_AgentIndices.clear();
+	m_Ticks.clear();
+	m_Deferred.clear();
+	m_Cursor = 0;
+	m_NextPhase = 0;
+}
+
+void BehaviourTreeScheduler::Register(BehaviourTree* tree, BehaviourTickPriority priority)
+{
+	if (!tree || m_AgentIndices.find(tree) != m_AgentIndices.end())
+		return;
+
+	// Consecutive phases spread agents with the same interval evenly across frames
+	m_AgentIndices.emplace(tree, m_Agents.size());
+	m_Agents.emplace_back(Agent { tree, priority, m_NextPhase++, 0.0f, false });
+}
+
+void BehaviourTreeScheduler::Unregister(BehaviourTree* tree)
+{
+	auto it = m_AgentIndices.find(tree);
+	if (it == m_AgentIndices.end())
+		return;
+
+	// Swap with last agent
+	size_t index = it->second;
+	m_AgentIndices.erase(it);
+	if (index != m_Agents.size() - 1)
+	{
+		m_Agents[index] = m_Agents.back();
+		m_AgentIndices[m_Agents[index].Tree] = index;
+	}
+	m_Agents.pop_back();
+}
+
+void BehaviourTreeScheduler::SetPriority(BehaviourTree* tree, BehaviourTickPriority priority)
+{
+	auto it = m_AgentIndices.find(tree);
+	if (it != m_AgentIndices.end())
+		m_Agents[it->second].Priority = priority;
+}
+
+unsigned int BehaviourTreeScheduler::GetInterval(const Agent& agent, const Rectangle& view)
+{
+	switch (agent.Priority)
+	{
+	case BehaviourTickPriority::High: return 1;
+	case BehaviourTickPriority::Low: return max(m_Args.FarInterval, 1u);
+	default: break;
+	}
+
+	// Distance from view, zero when inside
+	GameObject* go = agent.Tree->GetParent();
+	Vec2& position = go->GetPosition();
+	float dx = max(max(view.x - position.x, position.x - (view.x + view.width)), 0.0f);
+	float dy = max(max(view.y - position.y, position.y - (view.y + view.height)), 0.0f);
+	float distanceSqr = dx * dx + dy * dy;
+
+	unsigned int interval = m_Args.NearInterval;
+	if (distanceSqr > m_Args.MidDistance * m_Args.MidDistance)
+		interval = m_Args.FarInterval;
+	else if (distanceSqr > 0.0f)
+		interval = m_Args.MidInterval;
+
+	BehaviourNode* pending = agent.Tree->GetPendingNode();
+	if (agent.Tree->IsSleeping() || (pending && pending->IsLongRunning()))
+		interval = max(interval, m_Args.LongRunningInterval);
+	return max(interval, 1u);
+}
+
+void BehaviourTreeScheduler::Update(float deltaTime, Rectangle view)
+{
+	m_Frame++;
+	m_TicksLastFrame = 0;
+	if (m_Agents.empty())
+		return;
+
+	m_Ticks.clear();
+	size_t count = m_Agents.size();
+	size_t start = m_Cursor % count;
+	size_t stop = start;
+	bool overBudget = false;
+	for (size_t i = 0; i < count; i++)
+	{
+		Agent& agent = m_Agents[(start + i) % count];
+		agent.DeltaTime += deltaTime;
+		if (overBudget)
+		{
+			agent.Deferred |= (m_Frame + agent.Phase) % GetInterval(agent, view) == 0;
+			continue;
+		}
+
+		if (!agent.Deferred && (m_Frame + agent.Phase) % GetInterval(agent, view) != 0)
+			continue;
+
+		m_Ticks.emplace_back(Tick { agent.Tree, agent.DeltaTime });
+		agent.DeltaTime = 0.0f;
+		agent.Deferred = false;
+		if (m_Args.MaxTicksPerFrame > 0 && m_Ticks.size() >= m_Args.MaxTicksPerFrame)
+		{
+			overBudget = true;
+			stop = (start + i + 1) % count;
+		}
+	}
+	m_Cursor = stop;
+
+	// Profiler records serially
+	if (m_Args.TreesPerJob == 0 || !JobSystem::IsRunning() || BehaviourProfiler::IsEnabled())
+	{
+		for (Tick& tick : m_Ticks)
+		{
+			// Trees can unregister agents while ticking (e.g. deleting a GameObject)
+			if (m_AgentIndices.find(tick.Tree) == m_AgentIndices.end())
+				continue;
+
+			tick.Tree->Update(tick.DeltaTime);
+			m_TicksLastFrame++;
+		}
+		return;
+	}
+
+	// First update of a tree finalises its shared definition
+	for (Tick& tick : m_Ticks)
+		tick.Tree->Prepare();
+
+	// Nodes only change their own agent's blackboard & state while ticking, everything else is deferred
+	if (m_Deferred.size() < m_Ticks.size())
+		m_Deferred.resize(m_Ticks.size());
+	JobSystem::ParallelFor((unsigned int)m_Ticks.size(), m_Args.TreesPerJob, [](unsigned int start, unsigned int end)
+	{
+		for (unsigned int i = start; i < end; i++)
+			m_Ticks[i].Tree->Update(m_Ticks[i].DeltaTime, &m_Deferred[i]);
+	});
+
+	// Applied in agent order, so results don't depend on which worker ticked which tree
+	for (size_t i = 0; i < m_Ticks.size(); i++)
+	{
+		for (function<void()>& action : m_Deferred[i])
+			action();
+		m_Deferred[i].clear();
+	}
+	m_TicksLastFrame = (unsigned int)m_Ticks.size();
+}
+
+size_t BehaviourTreeScheduler::GetAgentCount() { return m_Agents.size(); }
+unsigned int BehaviourTreeScheduler::GetTicksLastFrame() { return m_TicksLastFrame; }
@@ -0,0 +1,146 @@
+#include <cstring>
+#include <mutex>
+#include <algorithm>
+#include <Framework/BehaviourTrees/Blackboard.hpp>
+
+using namespace std;
+using namespace Framework::BT;
+
+/// --- REGISTRY --- ///
+BlackboardRegistry::Registry& BlackboardRegistry::GetRegistry()
+{
+	// Function-local so keys can safely be created during static initialisation
+	static Registry registry;
+	return registry;
+}
+
+unsigned int BlackboardRegistry::Register(const string& name, type_index type, size_t size, size_t alignment, void (*destruct)(void*))
+{
+	int existing = Find(name);
+	if (existing >= 0)
+	{
+		assert(GetSlot((unsigned int)existing).Type == type); // Same name used with different types
+		return (unsigned int)existing;
+	}
+
+	Registry& registry = GetRegistry();
+	unique_lock<shared_mutex> lock(registry.Mutex);
+	auto it = registry.Names.find(name);
+	if (it != registry.Names.end())
+		return it->second; // Registered by another thread since Find
+
+	assert(alignment <= alignof(max_align_t));
+	size_t offset = (registry.LayoutSize + alignment - 1) & ~(alignment - 1);
+	registry.LayoutSize = offset + size;
+
+	unsigned int slot = (unsigned int)registry.Slots.size();
+	registry.Slots.emplace_back(BlackboardSlot { name, type, offset, size, destruct });
+	registry.Names.emplace(name, slot);
+	return slot;
+}
+
+int BlackboardRegistry::Find(const string& name)
+{
+	Registry& registry = GetRegistry();
+	shared_lock<shared_mutex> lock(registry.Mutex);
+	auto it = registry.Names.find(name);
+	return it == registry.Names.end() ? -1 : (int)it->second;
+}
+
+const BlackboardSlot& BlackboardRegistry::GetSlot(unsigned int slot)
+{
+	Registry& registry = GetRegistry();
+	shared_lock<shared_mutex> lock(registry.Mutex);
+	return registry.Slots[slot];
+}
+
+unsigned int BlackboardRegistry::GetSlotCount()
+{
+	Registry& registry = GetRegistry();
+	shared_lock<shared_mutex> lock(registry.Mutex);
+	return (unsigned int)registry.Slots.size();
+}
+
+size_t BlackboardRegistry::GetLayoutSize()
+{
+	Registry& registry = GetRegistry();
+	shared_lock<shared_mutex> lock(registry.Mutex);
+	return registry.LayoutSize;
+}
+
+/// --- BLACKBOARD --- ///
+Blackboard::Blackboard() : m_Data(nullptr), m_Size(0), m_Blocks(), m_Capacity(0), m_Set(), m_Versions(), m_Version(0) { Grow(); }
+
+Blackboard::~Blackboard()
+{
+	Clear();
+	::operator delete(m_Data);
+	for (Block& block : m_Blocks)
+		::operator delete(block.Data);
+}
+
+void Blackboard::Grow()
+{
+	// Slot count first, slots registered in between only make size larger than needed
+	unsigned int slotCount = BlackboardRegistry::GetSlotCount();
+	size_t size = BlackboardRegistry::GetLayoutSize();
+	if (size > m_Capacity)
+	{
+		bool anySet = find(m_Set.begin(), m_Set.end(), 1) != m_Set.end();
+		if (!anySet)
+		{
+			// Nothing stored yet, nothing to keep in place
+			for (Block& block : m_Blocks)
+				::operator delete(block.Data);
+			m_Blocks.clear();
+			::operator delete(m_Data);
+			m_Data = (char*)::operator new(size);
+			m_Size = size;
+		}
+		else
+		{
+			size_t start = m_Capacity & ~(alignof(max_align_t) - 1);
+			m_Blocks.emplace_back(Block { start, size, (char*)::operator new(size - start) });
+		}
+		m_Capacity = size;
+	}
+	m_Set.resize(slotCount, 0);
+	m_Versions.resize(slotCount, 0);
+}
+
+char* Blackboard::BlockData(size_t offset) const
+{
+	for (const Block& block : m_Blocks)
+		if (offset < block.End)
+			return block.Data + (offset - block.Start);
+	return nullptr;
+}
+
+void Blackboard::Clear(unsigned int slot)
+{
+	if (!Has(slot))
+		return;
+	const BlackboardSlot& info = BlackboardRegistry::GetSlot(slot);
+	info.Destruct(Data<char>(info.Offset));
+	m_Set[slot] = 0;
+	Changed(slot);
+}
+
+void Blackboard::Clear()
+{
+	for (unsigned int i = 0; i < m_Set.size(); i++)
+		Clear(i);
+}
+
+bool Blackboard::Has(const string& name) const
+{
+	int slot = BlackboardRegistry::Find(name);
+	return slot >= 0 && Has((unsigned int)slot);
+}
+
+void Blackboard::Clear(const string& name)
+{
+	int slot = BlackboardRegistry::Find(name);
+	if (slot >= 0)
+		Clear((unsigned int)slot);
+}
@@ -0,0 +1,25 @@
+#include <Framework/BehaviourTrees/BlackboardKeys.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+const BlackboardKey<unsigned int> Keys::Target("Target");
+const BlackboardKey<unsigned int> Keys::Found("Found");
+const BlackboardKey<string> Keys::TargetTag("TargetTag");
+const BlackboardKey<vector<string>> Keys::TargetTags("TargetTags");
+
+const BlackboardKey<float> Keys::Sight("Sight");
+const BlackboardKey<float> Keys::FieldOfView("FieldOfView");
+const BlackboardKey<float> Keys::CanSeeSight("CanSee_Sight");
+const BlackboardKey<float> Keys::CanSeeFieldOfView("CanSee_FOV");
+
+const BlackboardKey<float> Keys::Speed("Speed");
+const BlackboardKey<Vec2> Keys::Direction("Direction");
+
+const BlackboardKey<float> Keys::CellSize("CellSize");
+const BlackboardKey<vector<Pathfinding::AStarCell*>> Keys::Path("Path");
+const BlackboardKey<Pathfinding::AStar*> Keys::AStar("AStar");
+const BlackboardKey<Pathfinding::Grid<Pathfinding::SquareGridNode>*> Keys::AStarGrid("AStarGrid");
+
+const BlackboardKey<unsigned int> Keys::RepeatCount("RepeatCount");
@@ -0,0 +1,345 @@
+#include <typeinfo>
+#include <raylib.h>
+#include <algorithm>
+#include <Framework/BehaviourTrees/CompiledTree.hpp>
+#include <Framework/BehaviourTrees/BehaviourProfiler.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+void CompiledTree::Clear() { m_Nodes.clear(); }
+
+void CompiledTree::Compile(BehaviourNode* root)
+{
+	Clear();
+	if (root)
+		Append(root, true);
+}
+
+void CompiledTree::Append(BehaviourNode* node, bool resumable)
+{
+	unsigned int index = (unsigned int)m_Nodes.size();
+	m_Nodes.emplace_back(CompiledNode { CompiledNodeType::Leaf, 0, node->m_StateOffset, node, nullptr, resumable });
+
+	// Exact type match, derived classes may override Execute
+	const type_info& type = typeid(*node);
+	CompiledNodeType compiledType = CompiledNodeType::Leaf;
+	if (type == typeid(Sequence) || type == typeid(Selector))
+	{
+		compiledType = type == typeid(Sequence) ? CompiledNodeType::Sequence : CompiledNodeType::Selector;
+		for (BehaviourNode* child : ((Composite*)node)->GetChildren())
+			if (child)
+				Append(child, resumable);
+	}
+	else if (type == typeid(ReactiveSelector))
+	{
+		// Guards are re-checked each tick, so children can't be resumed directly
+		compiledType = CompiledNodeType::ReactiveSelector;
+		for (BehaviourNode* child : ((Composite*)node)->GetChildren())
+		{
+			if (!child)
+				continue;
+			unsigned int childIndex = (unsigned int)m_Nodes.size();
+			Append(child, false);
+			m_Nodes[childIndex].Guard = ReactiveSelector::GetGuard(child);
+		}
+	}
+	else if (type == typeid(UtilitySelector))
+	{
+		// Scores are re-checked while a child is pending, so children can't be resumed directly
+		compiledType = CompiledNodeType::UtilitySelector;
+		for (BehaviourNode* child : ((Composite*)node)->GetChildren())
+			if (child)
+				Append(child, false);
+	}
+	else if (type == typeid(Inverse) || type == typeid(Succeeder))
+	{
+		// Inverse turns a pending child into failure, so must see every tick
+		compiledType = type == typeid(Inverse) ? CompiledNodeType::Inverse : CompiledNodeType::Succeeder;
+		if (BehaviourNode* child = ((Decorator*)node)->GetChild())
+			Append(child, resumable && type == typeid(Succeeder));
+	}
+	else if (type == typeid(Conditional))
+	{
+		compiledType = CompiledNodeType::Conditional;
+		if (BehaviourNode* child = ((Conditional*)node)->m_Child)
+			Append(child, false);
+	}
+
+	// Vector may have grown during recursion, don't hold reference to node
+	m_Nodes[index].Type = compiledType;
+	m_Nodes[index].End = (unsigned int)m_Nodes.size();
+}
+
+BehaviourResult CompiledTree::Execute(GameObject* go, char* state, CompiledTreeProgress& progress) const
+{
+	if (m_Nodes.empty())
+		return BehaviourResult::Failure;
+
+	TickState tick { state, -1, BehaviourResult::Failure, -1, nullptr, 0.0 };
+	if (progress.RunningLeaf >= 0 && progress.RunningLeaf < (int)m_Nodes.size())
+	{
+		BehaviourResult result = TickLeaf(progress.RunningLeaf, go, tick);
+		if (result == BehaviourResult::Pending)
+		{
+			progress.WakeTime = tick.WakeTime;
+			return result;
+		}
+
+		// Leaf finished, walk down from root and pass its result up through parents
+		tick.ResumedLeaf = progress.RunningLeaf;
+		tick.ResumedResult = result;
+	}
+
+	tick.RunningLeaf = -1;
+	tick.PendingLeaf = nullptr;
+	tick.WakeTime = 0.0;
+	BehaviourResult result = Tick(0, go, tick);
+	bool pending = result == BehaviourResult::Pending;
+	progress.RunningLeaf = pending ? tick.RunningLeaf : -1;
+	progress.PendingLeaf = pending ? tick.PendingLeaf : nullptr;
+	progress.WakeTime = pending ? tick.WakeTime : 0.0;
+	return result;
+}
+
+BehaviourResult CompiledTree::TickLeaf(unsigned int index, GameObject* go, TickState& tick) const
+{
+	if ((int)index == tick.ResumedLeaf)
+	{
+		tick.ResumedLeaf = -1;
+		return tick.ResumedResult;
+	}
+
+	const CompiledNode& node = m_Nodes[index];
+	ExecutionContext& execution = BehaviourNode::s_Execution;
+	execution.SleepNode = nullptr;
+
+	BehaviourResult result = node.Node->Tick(go);
+	if (result == BehaviourResult::Pending)
+	{
+		tick.RunningLeaf = node.Resumable ? (int)index : -1;
+		tick.PendingLeaf = node.Node;
+		tick.WakeTime = execution.SleepNode == node.Node ? execution.WakeTime : 0.0;
+	}
+	return result;
+}
+
+BehaviourResult CompiledTree::TickComposite(unsigned int index, GameObject* go, TickState& tick) const
+{
+	const CompiledNode& node = m_Nodes[index];
+	unsigned int firstChild = index + 1;
+	if (!go || firstChild >= node.End)
+		return BehaviourResult::Failure;
+
+	// State is index of pending child, anything outside of children range when not started
+	int& pending = *(int*)(tick.State + node.StateOffset);
+	bool started = pending >= (int)firstChild && pending < (int)node.End;
+
+	if (node.Type == CompiledNodeType::ReactiveSelector && started)
+	{
+		// Switch to higher priority child if its guard now passes
+		for (unsigned int child = firstChild; child < (unsigned int)pending; child = m_Nodes[child].End)
+		{
+			Conditional* guard = m_Nodes[child].Guard;
+			if (!guard || !guard->Evaluate(go))
+				continue;
+			BehaviourNode::ResetState(m_Nodes[pending].Node);
+			pending = (int)child;
+			break;
+		}
+	}
+	else if (!started)
+		pending = firstChild;
+
+	// Sequence stops on first failure, selectors on first success
+	BehaviourResult stopResult = node.Type == CompiledNodeType::Sequence ? BehaviourResult::Failure : BehaviourResult::Success;
+	while (pending < (int)node.End)
+	{
+		BehaviourResult result = Tick(pending, go, tick);
+		if (result == BehaviourResult::Pending)
+		{
+			if (node.Type != CompiledNodeType::ReactiveSelector)
+				return result;
+
+			// Wake in time to re-check guards of higher priority children
+			for (unsigned int child = firstChild; child < (unsigned int)pending; child = m_Nodes[child].End)
+				if (Conditional* guard = m_Nodes[child].Guard)
+					tick.WakeTime = guard->IsEventDriven() ? min(tick.WakeTime, guard->GetNextCheckTime()) : 0.0;
+			return result;
+		}
+		if (result == stopResult)
+		{
+			pending = 0;
+			return result;
+		}
+		pending = (int)m_Nodes[pending].End;
+	}
+	pending = 0;
+	return stopResult == BehaviourResult::Success ? BehaviourResult::Failure : BehaviourResult::Success;
+}
+
+unsigned int CompiledTree::GetChild(unsigned int index, int child) const
+{
+	unsigned int childIndex = index + 1;
+	for (int i = 0; i < child && childIndex < m_Nodes[index].End; i++)
+		childIndex = m_Nodes[childIndex].End;
+	return childIndex;
+}
+
+BehaviourResult CompiledTree::TickUtility(unsigned int index, GameObject* go, TickState& tick) const
+{
+	const CompiledNode& node = m_Nodes[index];
+	UtilitySelector* selector = (UtilitySelector*)node.Node;
+	if (!go || index + 1 >= node.End)
+		return BehaviourResult::Failure;
+
+	// Pending is index of committed child, find which child that is for scoring
+	UtilitySelectorState& state = *(UtilitySelectorState*)(tick.State + node.StateOffset);
+	int committed = -1;
+	int child = 0;
+	for (unsigned int childIndex = index + 1; childIndex < node.End; childIndex = m_Nodes[childIndex].End, child++)
+		if ((int)childIndex == state.Pending)
+			committed = child;
+	if (committed < 0)
+		state.Pending = -1;
+
+	// Keep running committed child until scores are due
+	int failed = -1;
+	if (committed >= 0 && GetTime() < state.NextCheckTime)
+	{
+		BehaviourResult result = Tick(state.Pending, go, tick);
+		if (result == BehaviourResult::Pending)
+		{
+			if (tick.WakeTime > 0.0)
+				tick.WakeTime = min(tick.WakeTime, state.NextCheckTime);
+			return result;
+		}
+		if (result == BehaviourResult::Success)
+		{
+			state.Pending = -1;
+			return result;
+		}
+		failed = committed;
+		committed = -1;
+		state.Pending = -1;
+	}
+
+	int order[UtilitySelector::MaxChildren];
+	unsigned int count = selector->Rank(go, committed, order);
+	state.NextCheckTime = GetTime() + selector->RecheckInterval;
+
+	// Abort committed child when another takes over
+	if (committed >= 0 && (count == 0 || order[0] != committed))
+		BehaviourNode::ResetState(m_Nodes[state.Pending].Node);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		int next = order[i];
+		if (next == failed)
+			continue;
+		unsigned int childIndex = GetChild(index, next);
+		BehaviourResult result = Tick(childIndex, go, tick);
+		if (result == BehaviourResult::Failure)
+			continue;
+
+		state.Pending = result == BehaviourResult::Pending ? (int)childIndex : -1;
+		if (result == BehaviourResult::Pending && tick.WakeTime > 0.0)
+			tick.WakeTime = min(tick.WakeTime, state.NextCheckTime); // Wake in time to re-check scores
+		return result;
+	}
+
+	state.Pending = -1;
+	return BehaviourResult::Failure;
+}
+
+BehaviourResult CompiledTree::Tick(unsigned int index, GameObject* go, TickState& tick) const
+{
+	// Leaves are recorded by BehaviourNode::Tick
+	const CompiledNode& node = m_Nodes[index];
+	if (node.Type == CompiledNodeType::Leaf || !BehaviourProfiler::IsEnabled())
+		return TickNode(index, go, tick);
+
+	BehaviourProfiler::Begin(node.Node);
+	BehaviourResult result = TickNode(index, go, tick);
+	BehaviourProfiler::End(node.Node, result);
+	return result;
+}
+
+BehaviourResult CompiledTree::TickNode(unsigned int index, GameObject* go, TickState& tick) const
+{
+	const CompiledNode& node = m_Nodes[index];
+	unsigned int firstChild = index + 1;
+	bool hasChild = firstChild < node.End;
+
+	switch (node.Type)
+	{
+	default:
+	case CompiledNodeType::Leaf: return TickLeaf(index, go, tick);
+
+	case CompiledNodeType::Sequence:
+	case CompiledNodeType::Selector:
+	case CompiledNodeType::ReactiveSelector:
+		return TickComposite(index, go, tick);
+
+	case CompiledNodeType::UtilitySelector:
+		return TickUtility(index, go, tick);
+
+	case CompiledNodeType::Inverse:
+		if (!go || !hasChild)
+			return BehaviourResult::Failure;
+		return Tick(firstChild, go, tick) == BehaviourResult::Failure ? BehaviourResult::Success : BehaviourResult::Failure;
+
+	case CompiledNodeType::Succeeder:
+	{
+		BehaviourResult result = BehaviourResult::Success;
+		if (go && hasChild)
+			result = Tick(firstChild, go, tick);
+		return result == BehaviourResult::Pending ? result : BehaviourResult::Success;
+	}
+
+	case CompiledNodeType::Conditional:
+	{
+		Conditional* conditional = (Conditional*)node.Node;
+		if (!go || !conditional->Evaluate(go))
+			return BehaviourResult::Failure;
+		if (!hasChild)
+			return BehaviourResult::Success;
+
+		BehaviourResult result = Tick(firstChild, go, tick);
+		if (result == BehaviourResult::Pending)
+			tick.WakeTime = conditional->IsEventDriven() ? min(tick.WakeTime, conditional->GetNextCheckTime()) : 0.0;
+		return result;
+	}
+	}
+}
+
+void CompiledTree::DebugDraw(GameObject* go, const char* state) const
+{
+	unsigned int index = 0;
+	while (index < m_Nodes.size())
+	{
+		const CompiledNode& node = m_Nodes[index];
+		switch (node.Type)
+		{
+		case CompiledNodeType::Leaf:
+			node.Node->OnDebugDraw(go);
+			return;
+
+		case CompiledNodeType::Sequence:
+		case CompiledNodeType::Selector:
+		case CompiledNodeType::ReactiveSelector:
+		case CompiledNodeType::UtilitySelector:
+		{
+			int pending = *(const int*)(state + node.StateOffset);
+			index = (pending <= (int)index || pending >= (int)node.End) ? index + 1 : (unsigned int)pending;
+			break;
+		}
+
+		default: index++; break;
+		}
+
+		if (index >= node.End)
+			return; // No children
+	}
+}
@@ -0,0 +1,35 @@
+#include <raylib.h>
+#include <algorithm>
+#include <Framework/BehaviourTrees/Coroutine.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+using namespace Framework::Pathfinding;
+
+/// --- TIMER --- ///
+Timer::Timer(float seconds) : m_EndTime(GetTime() + seconds) { }
+
+float Timer::GetTimeLeft() { return (float)max(m_EndTime - GetTime(), 0.0); }
+
+bool Timer::IsReady() { return GetTime() >= m_EndTime; }
+
+/// --- PATH TICKET --- ///
+PathTicket::PathTicket(AStarCell* start, AStarCell* end, unsigned int stepsPerPoll) :
+	m_Search(), m_Started(start && end), StepsPerPoll(stepsPerPoll)
+{
+	if (m_Started)
+		m_Search.StartSearch(start, end);
+}
+
+vector<AStarCell*> PathTicket::GetPath() { return m_Started ? m_Search.GetPath() : vector<AStarCell*>(); }
+
+bool PathTicket::IsReady()
+{
+	if (!m_Started)
+		return true;
+
+	for (unsigned int i = 0; i < StepsPerPoll && !m_Search.IsFinished(); i++)
+		m_Search.Step();
+	return m_Search.IsFinished();
+}
@@ -0,0 +1,266 @@
+#include <cmath>
+#include <raylib.h>
+#include <Framework/BehaviourTrees/NodeRegistry.hpp>
+#include <Framework/BehaviourTrees/Actions/Move.hpp>
+#include <Framework/BehaviourTrees/Actions/Wait.hpp>
+#include <Framework/BehaviourTrees/Actions/CanSee.hpp>
+#include <Framework/BehaviourTrees/Actions/FindPath.hpp>
+#include <Framework/BehaviourTrees/Actions/FindFirst.hpp>
+#include <Framework/BehaviourTrees/Actions/LimitTime.hpp>
+#include <Framework/BehaviourTrees/Actions/PlaySound.hpp>
+#include <Framework/BehaviourTrees/Actions/FindClosest.hpp>
+#include <Framework/BehaviourTrees/Actions/MoveTowards.hpp>
+#include <Framework/BehaviourTrees/Actions/ValueExists.hpp>
+#include <Framework/BehaviourTrees/Actions/CallFunction.hpp>
+#include <Framework/BehaviourTrees/Actions/ClimbInfluence.hpp>
+#include <Framework/BehaviourTrees/Actions/CanSeeTarget.hpp>
+#include <Framework/BehaviourTrees/Actions/NavigatePath.hpp>
+#include <Framework/BehaviourTrees/Actions/WithinDistance.hpp>
+#include <Framework/BehaviourTrees/Actions/FindClosestNavigatable.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+/// --- NODE VALUE --- ///
+bool NodeValue::Read(float& output) const
+{
+	if (ValueType != Type::Number)
+		return false;
+	output = (float)Number;
+	return true;
+}
+
+bool NodeValue::Read(unsigned int& output) const
+{
+	if (ValueType != Type::Number || Number < 0.0 || Number != floor(Number))
+		return false;
+	output = (unsigned int)Number;
+	return true;
+}
+
+bool NodeValue::Read(bool& output) const
+{
+	if (ValueType != Type::Boolean)
+		return false;
+	output = Number != 0.0;
+	return true;
+}
+
+bool NodeValue::Read(string& output) const
+{
+	if (ValueType != Type::String)
+		return false;
+	output = Text;
+	return true;
+}
+
+bool NodeValue::Read(vector<string>& output) const
+{
+	// Single string is read as a list of one
+	if (ValueType == Type::String)
+	{
+		output = { Text };
+		return true;
+	}
+	if (ValueType != Type::List)
+		return false;
+
+	vector<string> values;
+	for (const NodeValue& item : Items)
+		if (item.ValueType == Type::String)
+			values.emplace_back(item.Text);
+		else
+			return false;
+	output = move(values);
+	return true;
+}
+
+bool NodeValue::Read(Vec2& output) const
+{
+	if (ValueType != Type::List || Items.size() != 2 ||
+		Items[0].ValueType != Type::Number || Items[1].ValueType != Type::Number)
+		return false;
+	output = Vec2((float)Items[0].Number, (float)Items[1].Number);
+	return true;
+}
+
+/// --- NODE REGISTRY --- ///
+unordered_map<string, NodeRegistry::NodeType> NodeRegistry::m_Types;
+bool NodeRegistry::m_DefaultsRegistered = false;
+
+NodeRegistry::NodeType& NodeRegistry::AddType(const string& name)
+{
+	// Defaults first, so they don't replace a type registered before the first lookup
+	if (!m_DefaultsRegistered)
+		RegisterDefaults();
+
+	NodeType& type = m_Types[name];
+	type = NodeType();
+	return type;
+}
+
+NodeRegistry::NodeType* NodeRegistry::Find(const string& name)
+{
+	if (!m_DefaultsRegistered)
+		RegisterDefaults();
+
+	auto it = m_Types.find(name);
+	return it == m_Types.end() ? nullptr : &it->second;
+}
+
+void NodeRegistry::RegisterDefaults()
+{
+	m_DefaultsRegistered = true;
+
+	// Composites
+	Register<Sequence>("Sequence");
+	Register<Selector>("Selector");
+	Register<RandomSequence>("RandomSequence");
+	Register<RandomSelector>("RandomSelector");
+	Register<ReactiveSelector>("ReactiveSelector");
+	Register<UtilitySelector>("UtilitySelector")
+		.Field("Hysteresis", &UtilitySelector::Hysteresis)
+		.Field("RecheckInterval", &UtilitySelector::RecheckInterval)
+		.Property("Scores", [](UtilitySelector* node, const NodeValue& value)
+		{
+			// Score of each child in order, a callback name or constant
+			if (value.ValueType != NodeValue::Type::List)
+				return false;
+			node->Scores.clear();
+			for (const NodeValue& item : value.Items)
+			{
+				if (item.ValueType == NodeValue::Type::Number)
+				{
+					float score = (float)item.Number;
+					node->Scores.emplace_back([score](GameObject*, UtilitySelector*) { return score; });
+					continue;
+				}
+
+				UtilitySelector::ScoreType* callback = item.ValueType == NodeValue::Type::String ?
+					FindCallback<UtilitySelector::ScoreType>(item.Text) : nullptr;
+				if (!callback)
+					return false;
+				node->Scores.emplace_back(*callback);
+			}
+			return true;
+		});
+
+	Register<Conditional>("Conditional")
+		.Callback("Function", &Conditional::Function)
+		.Field("RecheckInterval", &Conditional::RecheckInterval)
+		.Property("Watch", [](Conditional* node, const NodeValue& value)
+		{
+			vector<string> keys;
+			if (!value.Read(keys))
+				return false;
+			for (const string& key : keys)
+				if (!node->Watch(key))
+					return false;
+			return true;
+		});
+
+	Register<Evaluator>("Evaluator")
+		.Callback("Function", &Evaluator::Function);
+
+	// Decorators
+	Register<Inverse>("Inverse");
+	Register<Succeeder>("Succeeder");
+	Register<Log>("Log")
+		.Field("Message", &Log::Message);
+	Register<DynamicLog>("DynamicLog")
+		.Callback("Message", &DynamicLog::Message);
+	Register<Repeat>("Repeat")
+		.Field("SingleFrame", &Repeat::SingleFrame)
+		.Callback("Condition", &Repeat::Condition);
+	Register<RepeatTime>("RepeatTime")
+		.Property("Time", [](RepeatTime* node, const NodeValue& value)
+		{
+			float time = 0.0f;
+			if (!value.Read(time))
+				return false;
+			node->SetTime(time);
+			return true;
+		});
+	Register<RepeatCount>("RepeatCount")
+		.Field("SingleFrame", &RepeatCount::SingleFrame)
+		.Field("Repetitions", &RepeatCount::Repetitions);
+	Register<RepeatUntilFail>("RepeatUntilFail")
+		.Field("SingleFrame", &RepeatUntilFail::SingleFrame);
+	Register<LimitTime>("LimitTime")
+		.Property("Time", [](LimitTime* node, const NodeValue& value)
+		{
+			float time = 0.0f;
+			if (!value.Read(time))
+				return false;
+			node->SetTime(time);
+			return true;
+		});
+
+	// Actions
+	Register<CallFunction>("CallFunction")
+		.Callback("Function", &CallFunction::Function);
+	Register<Wait>("Wait")
+		.Property("Time", [](Wait* node, const NodeValue& value)
+		{
+			float time = 0.0f;
+			if (!value.Read(time))
+				return false;
+			node->SetTime(time);
+			return true;
+		});
+	Register<Move>("Move")
+		.Field("Speed", &Move::Speed)
+		.Field("Direction", &Move::Direction)
+		.Field("GetValuesFromContext", &Move::GetValuesFromContext);
+	Register<MoveTowards>("MoveTowards")
+		.Field("Speed", &MoveTowards::Speed)
+		.Field("TargetID", &MoveTowards::TargetID)
+		.Field("GetValuesFromContext", &MoveTowards::GetValuesFromContext);
+	Register<NavigatePath>("NavigatePath")
+		.Field("Speed", &NavigatePath::Speed);
+	Register<FindPath>("FindPath")
+		.Field("StepsPerUpdate", &FindPath::StepsPerUpdate);
+	Register<FindFirst>("FindFirst")
+		.Field("Tag", &FindFirst::Tag)
+		.Field("GetTagFromContext", &FindFirst::GetTagFromContext);
+	Register<FindClosest>("FindClosest")
+		.Field("Sight", &FindClosest::Sight)
+		.Field("TargetTag", &FindClosest::TargetTag)
+		.Field("GetTargetFromContext", &FindClosest::GetTargetFromContext);
+	Register<FindClosestNavigatable>("FindClosestNavigatable")
+		.Field("Sight", &FindClosestNavigatable::Sight)
+		.Field("TargetTags", &FindClosestNavigatable::TargetTags)
+		.Field("GetTargetFromContext", &FindClosestNavigatable::GetTargetFromContext)
+		.Field("StepsPerUpdate", &FindClosestNavigatable::StepsPerUpdate);
+	Register<ClimbInfluence>("ClimbInfluence")
+		.Field("Map", &ClimbInfluence::Map)
+		.Field("MinimumInfluence", &ClimbInfluence::MinimumInfluence);
+	Register<CanSee>("CanSee")
+		.Field("SightRange", &CanSee::SightRange)
+		.Field("FieldOfView", &CanSee::FieldOfView)
+		.Field("TargetTag", &CanSee::TargetTag)
+		.Field("MaxCandidates", &CanSee::MaxCandidates)
+		.Field("GetValuesFromContext", &CanSee::GetValuesFromContext);
+	Register<CanSeeTarget>("CanSeeTarget")
+		.Field("SightRange", &CanSeeTarget::SightRange)
+		.Field("FieldOfView", &CanSeeTarget::FieldOfView)
+		.Field("TargetID", &CanSeeTarget::TargetID)
+		.Field("GetTargetFromContext", &CanSeeTarget::GetTargetFromContext);
+	Register<WithinDistance>("WithinDistance")
+		.Field("MaxDistance", &WithinDistance::MaxDistance)
+		.Field("TargetID", &WithinDistance::TargetID)
+		.Field("GetTargetFromContext", &WithinDistance::GetTargetFromContext);
+	Register<ValueExists>("ValueExists")
+		.Field("Name", &ValueExists::m_Name);
+	Register<BT::PlaySound>("PlaySound")
+		.Field("WaitForFinish", &BT::PlaySound::WaitForFinish)
+		.Property("Sound", [](BT::PlaySound* node, const NodeValue& value)
+		{
+			string path;
+			if (!value.Read(path) || !FileExists(path.c_str()))
+				return false;
+			node->Sound = LoadSound(path.c_str());
+			return true;
+		});
+}
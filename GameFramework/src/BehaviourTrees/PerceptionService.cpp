@@ -0,0 +1,405 @@
+#include <cmath>
+#include <algorithm>
+#pragma warning(push, 0) // Disable warnings
+#include <box2d/b2_world.h>
+#include <box2d/b2_fixture.h>
+#pragma warning(pop) // Restore warnings
+
+#include <Framework/SpatialHash.hpp>
+#include <Framework/PhysicsWorld.hpp>
+#include <Framework/OcclusionGrid.hpp>
+#include <Framework/Jobs/JobSystem.hpp>
+#include <Framework/BehaviourTrees/PerceptionService.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+/// --- VISIBILITY TICKET --- ///
+unsigned int VisibilityTicket::GetVisible() { return m_Query && m_Query->Resolved ? m_Query->Visible : (unsigned int)-1; }
+
+bool VisibilityTicket::IsReady() { return !m_Query || m_Query->Resolved; }
+
+/// --- PERCEPTION SERVICE --- ///
+PerceptionServiceArgs PerceptionService::m_Args;
+bool PerceptionService::m_Initialised = false;
+vector<shared_ptr<VisibilityQuery>> PerceptionService::m_Queries;
+mutex PerceptionService::m_QueriesMutex;
+
+vector<PerceptionService::Entry> PerceptionService::m_Entries;
+vector<unsigned int> PerceptionService::m_CellStarts;
+vector<unsigned int> PerceptionService::m_CellEntries;
+b2Vec2 PerceptionService::m_GridOrigin = { 0, 0 };
+float PerceptionService::m_GridCellSize = 64.0f;
+int PerceptionService::m_GridWidth = 0;
+int PerceptionService::m_GridHeight = 0;
+
+vector<PerceptionService::Ray> PerceptionService::m_Rays;
+vector<uint8_t> PerceptionService::m_RayVisible;
+unsigned int PerceptionService::m_RaysLastFrame = 0;
+
+vector<PerceptionService::Observer> PerceptionService::m_Observers;
+unordered_map<GameObject*, size_t> PerceptionService::m_ObserverIndices;
+
+void PerceptionService::Init(PerceptionServiceArgs args)
+{
+	m_Args = args;
+	m_Args.PacketSize = max(m_Args.PacketSize, 1u);
+	m_Args.PacketsPerJob = max(m_Args.PacketsPerJob, 1u);
+	m_Args.ObserversPerJob = max(m_Args.ObserversPerJob, 1u);
+	m_Initialised = true;
+}
+
+void PerceptionService::Destroy()
+{
+	// Resolve anything outstanding so no ticket waits forever
+	Update();
+	m_Initialised = false;
+
+	m_Entries.clear();
+	m_CellStarts.clear();
+	m_CellEntries.clear();
+	m_Rays.clear();
+	m_RayVisible.clear();
+	m_Observers.clear();
+	m_ObserverIndices.clear();
+}
+
+unsigned int PerceptionService::GetRaysLastFrame() { return m_RaysLastFrame; }
+
+VisibilityTicket PerceptionService::Submit(VisibilityQuery query)
+{
+	query.Resolved = false;
+	query.Visible = (unsigned int)-1;
+	shared_ptr<VisibilityQuery> shared = make_shared<VisibilityQuery>(move(query));
+
+	// Behaviour trees submit from several job threads
+	lock_guard<mutex> lock(m_QueriesMutex);
+	m_Queries.emplace_back(shared);
+
+	if (!m_Initialised)
+		Update();
+	return VisibilityTicket(shared);
+}
+
+// Collects fixtures overlapping the area every ray is in
+class SnapshotCallback : public b2QueryCallback
+{
+public:
+	vector<b2Fixture*> Fixtures;
+
+	bool ReportFixture(b2Fixture* fixture) override
+	{
+		// Static occluders are already in OcclusionGrid
+		if (!fixture->IsSensor() && !OcclusionGrid::IsOccluder((unsigned int)fixture->GetUserData().pointer))
+			Fixtures.emplace_back(fixture);
+		return true; // Continue query
+	}
+};
+
+void PerceptionService::GetCellRange(const b2AABB& bounds, int& minX, int& minY, int& maxX, int& maxY)
+{
+	minX = clamp((int)floor((bounds.lowerBound.x - m_GridOrigin.x) / m_GridCellSize), 0, m_GridWidth - 1);
+	minY = clamp((int)floor((bounds.lowerBound.y - m_GridOrigin.y) / m_GridCellSize), 0, m_GridHeight - 1);
+	maxX = clamp((int)floor((bounds.upperBound.x - m_GridOrigin.x) / m_GridCellSize), 0, m_GridWidth - 1);
+	maxY = clamp((int)floor((bounds.upperBound.y - m_GridOrigin.y) / m_GridCellSize), 0, m_GridHeight - 1);
+}
+
+void PerceptionService::BuildSnapshot(const b2AABB& bounds)
+{
+	m_Entries.clear();
+
+	// One broadphase traversal for the whole batch
+	SnapshotCallback callback;
+	b2World* world = PhysicsWorld::GetBox2DWorld();
+	if (world && m_Args.DynamicOccluders)
+		world->QueryAABB(&callback, bounds);
+
+	for (b2Fixture* fixture : callback.Fixtures)
+	{
+		b2AABB fixtureBounds = fixture->GetAABB(0);
+		for (int32 child = 1; child < fixture->GetShape()->GetChildCount(); child++)
+		{
+			const b2AABB& childBounds = fixture->GetAABB(child);
+			fixtureBounds.lowerBound = b2Vec2(min(fixtureBounds.lowerBound.x, childBounds.lowerBound.x), min(fixtureBounds.lowerBound.y, childBounds.lowerBound.y));
+			fixtureBounds.upperBound = b2Vec2(max(fixtureBounds.upperBound.x, childBounds.upperBound.x), max(fixtureBounds.upperBound.y, childBounds.upperBound.y));
+		}
+		m_Entries.emplace_back(Entry { fixture, fixtureBounds, (unsigned int)fixture->GetUserData().pointer });
+	}
+
+	// Cells grow when bounds are large, keeping grid within MaxGridCells
+	float width = bounds.upperBound.x - bounds.lowerBound.x;
+	float height = bounds.upperBound.y - bounds.lowerBound.y;
+	m_GridCellSize = max(m_Args.CellSize, 1.0f);
+	while ((width / m_GridCellSize + 1.0f) * (height / m_GridCellSize + 1.0f) > (float)max(m_Args.MaxGridCells, 1u))
+		m_GridCellSize *= 2.0f;
+	m_GridOrigin = bounds.lowerBound;
+	m_GridWidth = (int)(width / m_GridCellSize) + 1;
+	m_GridHeight = (int)(height / m_GridCellSize) + 1;
+
+	// Counting sort of entries into cells, an entry is in every cell its bounds touch
+	size_t cellCount = (size_t)m_GridWidth * m_GridHeight;
+	m_CellStarts.assign(cellCount + 1, 0);
+	int minX, minY, maxX, maxY;
+	for (const Entry& entry : m_Entries)
+	{
+		GetCellRange(entry.Bounds, minX, minY, maxX, maxY);
+		for (int y = minY; y <= maxY; y++)
+			for (int x = minX; x <= maxX; x++)
+				m_CellStarts[(size_t)y * m_GridWidth + x + 1]++;
+	}
+	for (size_t i = 1; i <= cellCount; i++)
+		m_CellStarts[i] += m_CellStarts[i - 1];
+
+	m_CellEntries.resize(m_CellStarts[cellCount]);
+	vector<unsigned int> cursors(m_CellStarts.begin(), m_CellStarts.end() - 1);
+	for (unsigned int i = 0; i < (unsigned int)m_Entries.size(); i++)
+	{
+		GetCellRange(m_Entries[i].Bounds, minX, minY, maxX, maxY);
+		for (int y = minY; y <= maxY; y++)
+			for (int x = minX; x <= maxX; x++)
+				m_CellEntries[cursors[(size_t)y * m_GridWidth + x]++] = i;
+	}
+}
+
+void PerceptionService::TracePacket(unsigned int start, unsigned int end, vector<unsigned int>& candidates)
+{
+	// Candidates shared by every ray in packet, found with one walk over the grid
+	b2AABB bounds = m_Rays[start].Bounds;
+	for (unsigned int i = start + 1; i < end; i++)
+	{
+		bounds.lowerBound = b2Vec2(min(bounds.lowerBound.x, m_Rays[i].Bounds.lowerBound.x), min(bounds.lowerBound.y, m_Rays[i].Bounds.lowerBound.y));
+		bounds.upperBound = b2Vec2(max(bounds.upperBound.x, m_Rays[i].Bounds.upperBound.x), max(bounds.upperBound.y, m_Rays[i].Bounds.upperBound.y));
+	}
+
+	candidates.clear();
+	int minX, minY, maxX, maxY;
+	GetCellRange(bounds, minX, minY, maxX, maxY);
+	for (int y = minY; y <= maxY; y++)
+		for (int x = minX; x <= maxX; x++)
+		{
+			size_t cell = (size_t)y * m_GridWidth + x;
+			candidates.insert(candidates.end(), m_CellEntries.begin() + m_CellStarts[cell], m_CellEntries.begin() + m_CellStarts[cell + 1]);
+		}
+	sort(candidates.begin(), candidates.end());
+	candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+	for (unsigned int i = start; i < end; i++)
+	{
+		const Ray& ray = m_Rays[i];
+		if (!OcclusionGrid::Trace(ray.From, ray.To))
+		{
+			m_RayVisible[i] = 0;
+			continue;
+		}
+
+		b2RayCastInput input;
+		input.p1 = ray.From;
+		input.p2 = ray.To;
+		input.maxFraction = 1.0f;
+
+		// Closest fixture along ray, the target is visible if it's hit first or nothing is
+		float closest = 1.0f;
+		unsigned int closestID = (unsigned int)-1;
+		for (unsigned int candidate : candidates)
+		{
+			const Entry& entry = m_Entries[candidate];
+			if (entry.ID == ray.Observer || !b2TestOverlap(entry.Bounds, ray.Bounds))
+				continue;
+
+			for (int32 child = 0; child < entry.Fixture->GetShape()->GetChildCount(); child++)
+			{
+				b2RayCastOutput output;
+				if (entry.Fixture->RayCast(&output, input, child) && output.fraction < closest)
+				{
+					closest = output.fraction;
+					closestID = entry.ID;
+				}
+			}
+		}
+		m_RayVisible[i] = closestID == (unsigned int)-1 || closestID == ray.Target;
+	}
+}
+
+void PerceptionService::Update()
+{
+	m_RaysLastFrame = 0;
+	if (m_Queries.empty())
+		return;
+
+	// One ray per query target
+	m_Rays.clear();
+	b2AABB bounds;
+	for (unsigned int q = 0; q < (unsigned int)m_Queries.size(); q++)
+	{
+		VisibilityQuery& query = *m_Queries[q];
+		for (auto& target : query.Targets)
+		{
+			Ray ray;
+			ray.Query = q;
+			ray.Observer = query.Observer;
+			ray.Target = target.first;
+			ray.From = query.From;
+			ray.To = target.second;
+			ray.Bounds.lowerBound = b2Vec2(min(ray.From.x, ray.To.x), min(ray.From.y, ray.To.y));
+			ray.Bounds.upperBound = b2Vec2(max(ray.From.x, ray.To.x), max(ray.From.y, ray.To.y));
+			ray.Cell = 0;
+
+			if (m_Rays.empty())
+				bounds = ray.Bounds;
+			bounds.lowerBound = b2Vec2(min(bounds.lowerBound.x, ray.Bounds.lowerBound.x), min(bounds.lowerBound.y, ray.Bounds.lowerBound.y));
+			bounds.upperBound = b2Vec2(max(bounds.upperBound.x, ray.Bounds.upperBound.x), max(bounds.upperBound.y, ray.Bounds.upperBound.y));
+			m_Rays.emplace_back(ray);
+		}
+	}
+
+	if (!m_Rays.empty())
+	{
+		BuildSnapshot(bounds);
+
+		// Rays starting in the same cell end up in the same packets, so share most of their candidates
+		for (Ray& ray : m_Rays)
+		{
+			int x = clamp((int)((ray.From.x - m_GridOrigin.x) / m_GridCellSize), 0, m_GridWidth - 1);
+			int y = clamp((int)((ray.From.y - m_GridOrigin.y) / m_GridCellSize), 0, m_GridHeight - 1);
+			ray.Cell = (unsigned int)(y * m_GridWidth + x);
+		}
+		stable_sort(m_Rays.begin(), m_Rays.end(), [](const Ray& a, const Ray& b) { return a.Cell < b.Cell; });
+
+		// Snapshot & rays are read-only while tracing, each ray's result is only written by its packet
+		m_RayVisible.assign(m_Rays.size(), 0);
+		unsigned int rayCount = (unsigned int)m_Rays.size();
+		unsigned int packetSize = m_Args.PacketSize;
+		unsigned int packetCount = (rayCount + packetSize - 1) / packetSize;
+		JobSystem::ParallelFor(packetCount, m_Args.PacketsPerJob, [=](unsigned int startPacket, unsigned int endPacket)
+		{
+			vector<unsigned int> candidates;
+			for (unsigned int packet = startPacket; packet < endPacket; packet++)
+				TracePacket(packet * packetSize, min((packet + 1) * packetSize, rayCount), candidates);
+		});
+	}
+
+	// First visible target in each query's order of preference
+	for (auto& query : m_Queries)
+		query->Visible = (unsigned int)-1;
+	vector<unsigned int> visibleRank(m_Queries.size(), (unsigned int)-1);
+	for (unsigned int i = 0; i < (unsigned int)m_Rays.size(); i++)
+	{
+		if (!m_RayVisible[i])
+			continue;
+		VisibilityQuery& query = *m_Queries[m_Rays[i].Query];
+		for (unsigned int rank = 0; rank < (unsigned int)query.Targets.size() && rank < visibleRank[m_Rays[i].Query]; rank++)
+		{
+			if (query.Targets[rank].first != m_Rays[i].Target)
+				continue;
+			visibleRank[m_Rays[i].Query] = rank;
+			query.Visible = m_Rays[i].Target;
+			break;
+		}
+	}
+	for (auto& query : m_Queries)
+		query->Resolved = true;
+
+	m_RaysLastFrame = (unsigned int)m_Rays.size();
+	m_Queries.clear();
+}
+
+void PerceptionService::AddObserver(GameObject* go)
+{
+	if (!go || m_ObserverIndices.find(go) != m_ObserverIndices.end())
+		return;
+
+	m_ObserverIndices[go] = m_Observers.size();
+	m_Observers.emplace_back(Observer { go, { }, false });
+}
+
+void PerceptionService::RemoveObserver(GameObject* go)
+{
+	auto it = m_ObserverIndices.find(go);
+	if (it == m_ObserverIndices.end())
+		return;
+
+	// Swap with last observer
+	size_t index = it->second;
+	m_ObserverIndices.erase(it);
+	if (index != m_Observers.size() - 1)
+	{
+		m_Observers[index] = move(m_Observers.back());
+		m_ObserverIndices[m_Observers[index].Object] = index;
+	}
+	m_Observers.pop_back();
+}
+
+void PerceptionService::UpdateNeighbours()
+{
+	if (!m_Initialised || m_Observers.empty())
+		return;
+
+	// SpatialHash & positions are only read while building, each job writes its own observers
+	float range = m_Args.NeighbourRange;
+	JobSystem::ParallelFor((unsigned int)m_Observers.size(), m_Args.ObserversPerJob, [=](unsigned int start, unsigned int end)
+	{
+		vector<GameObject*> found;
+		for (unsigned int i = start; i < end; i++)
+		{
+			Observer& observer = m_Observers[i];
+			Vec2 position = observer.Object->GetPosition();
+
+			found.clear();
+			SpatialHash::QueryRadius(position, range, AnyTag, found);
+
+			observer.Neighbours.clear();
+			for (GameObject* other : found)
+				if (other != observer.Object)
+					observer.Neighbours.emplace_back(Neighbour { other, position.DistanceSqr(other->GetPosition()) });
+			sort(observer.Neighbours.begin(), observer.Neighbours.end(),
+				[](const Neighbour& a, const Neighbour& b) { return a.DistanceSqr < b.DistanceSqr; });
+			observer.Built = true;
+		}
+	});
+}
+
+void PerceptionService::QueryNeighbours(GameObject* go, float range, TagMask mask, vector<GameObject*>& output)
+{
+	auto it = m_ObserverIndices.find(go);
+	if (m_Initialised && it != m_ObserverIndices.end() && m_Observers[it->second].Built && range <= m_Args.NeighbourRange)
+	{
+		float rangeSqr = range * range;
+		for (const Neighbour& neighbour : m_Observers[it->second].Neighbours)
+		{
+			if (neighbour.DistanceSqr > rangeSqr)
+				break; // Sorted, rest are further away
+			if ((neighbour.Object->GetTagMask() & mask) && !neighbour.Object->IsDestroyed())
+				output.emplace_back(neighbour.Object);
+		}
+		return;
+	}
+
+	// Not cached, same result straight from SpatialHash
+	Vec2 position = go->GetPosition();
+	size_t first = output.size();
+	SpatialHash::QueryRadius(position, range, mask, output);
+	output.erase(remove(output.begin() + first, output.end(), go), output.end());
+	sort(output.begin() + first, output.end(), [&](GameObject* a, GameObject* b)
+		{ return position.DistanceSqr(a->GetPosition()) < position.DistanceSqr(b->GetPosition()); });
+}
+
+GameObject* PerceptionService::FindNearestNeighbour(GameObject* go, float range, TagMask mask)
+{
+	auto it = m_ObserverIndices.find(go);
+	if (!m_Initialised || it == m_ObserverIndices.end() || !m_Observers[it->second].Built || range > m_Args.NeighbourRange)
+	{
+		vector<GameObject*> found = SpatialHash::QueryNearest(go->GetPosition(), 1, mask, range, go);
+		return found.empty() ? nullptr : found[0];
+	}
+
+	float rangeSqr = range * range;
+	for (const Neighbour& neighbour : m_Observers[it->second].Neighbours)
+	{
+		if (neighbour.DistanceSqr > rangeSqr)
+			break;
+		if ((neighbour.Object->GetTagMask() & mask) && !neighbour.Object->IsDestroyed())
+			return neighbour.Object;
+	}
+	return nullptr;
+}
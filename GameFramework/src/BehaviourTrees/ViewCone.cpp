@@ -0,0 +1,92 @@
+#include <cmath>
+#include <Framework/BehaviourTrees/ViewCone.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VIEWCONE_SSE
+#endif
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::BT;
+
+ViewCone::ViewCone(Vec2 origin, Vec2 forward, float fovRadians, float range) :
+	Origin(origin), Forward(forward.Normalized()), CosHalfAngle(cosf(fovRadians / 2.0f)), RangeSquared(range * range) { }
+
+ViewCone::ViewCone(GameObject* observer, float fovRadians, float range) :
+	ViewCone(observer->GetPosition(), observer->GetForward(), fovRadians, range) { }
+
+// Angle to offset is within half angle when dot > cos * length.
+// Both sides are multiplied by their own absolute value, which keeps the comparison & removes the sqrt
+bool ViewCone::Contains(Vec2 point) const
+{
+	float dx = point.x - Origin.x;
+	float dy = point.y - Origin.y;
+	float lengthSquared = dx * dx + dy * dy;
+	float dot = Forward.x * dx + Forward.y * dy;
+	return lengthSquared <= RangeSquared &&
+		dot * fabsf(dot) > CosHalfAngle * fabsf(CosHalfAngle) * lengthSquared;
+}
+
+void ViewCone::Filter(const float* x, const float* y, unsigned int count, vector<unsigned int>& output) const
+{
+	unsigned int i = 0;
+	float cosSquaredSigned = CosHalfAngle * fabsf(CosHalfAngle);
+
+#ifdef VIEWCONE_SSE
+	const __m128 originX = _mm_set1_ps(Origin.x);
+	const __m128 originY = _mm_set1_ps(Origin.y);
+	const __m128 forwardX = _mm_set1_ps(Forward.x);
+	const __m128 forwardY = _mm_set1_ps(Forward.y);
+	const __m128 cosSquared = _mm_set1_ps(cosSquaredSigned);
+	const __m128 rangeSquared = _mm_set1_ps(RangeSquared);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), originX);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), originY);
+		__m128 lengthSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		__m128 dot = _mm_add_ps(_mm_mul_ps(forwardX, dx), _mm_mul_ps(forwardY, dy));
+
+		__m128 inAngle = _mm_cmpgt_ps(_mm_mul_ps(dot, _mm_and_ps(dot, absMask)), _mm_mul_ps(cosSquared, lengthSquared));
+		__m128 inRange = _mm_cmple_ps(lengthSquared, rangeSquared);
+		int mask = _mm_movemask_ps(_mm_and_ps(inAngle, inRange));
+
+		for (unsigned int lane = 0; mask; lane++, mask >>= 1)
+			if (mask & 1)
+				output.emplace_back(i + lane);
+	}
+#endif
+
+	// Remainder, or everything without SSE
+	for (; i < count; i++)
+	{
+		float dx = x[i] - Origin.x;
+		float dy = y[i] - Origin.y;
+		float lengthSquared = dx * dx + dy * dy;
+		float dot = Forward.x * dx + Forward.y * dy;
+		if (lengthSquared <= RangeSquared && dot * fabsf(dot) > cosSquaredSigned * lengthSquared)
+			output.emplace_back(i);
+	}
+}
+
+void ViewCone::Filter(const vector<GameObject*>& candidates, vector<GameObject*>& output) const
+{
+	// Reused between calls, perception nodes run on the main thread
+	static vector<float> x, y;
+	static vector<unsigned int> inside;
+	x.resize(candidates.size());
+	y.resize(candidates.size());
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		Vec2& position = candidates[i]->GetPosition();
+		x[i] = position.x;
+		y[i] = position.y;
+	}
+
+	inside.clear();
+	Filter(x.data(), y.data(), (unsigned int)candidates.size(), inside);
+	for (unsigned int index : inside)
+		output.emplace_back(candidates[index]);
+}
@@ -1,11 +1,21 @@
+#include <mutex>
+#include <cassert>
+#include <algorithm>
+#include <Framework/Logger.hpp>
 #include <Framework/GameObject.hpp>
+#include <Framework/SpatialHash.hpp>
 #include <Framework/PhysicsWorld.hpp>
+#include <Framework/Jobs/JobSystem.hpp>
 
 using namespace std;
 using namespace Framework;
 
 robin_hood::unordered_map<unsigned int, GameObject*> GameObject::m_IDs;
 robin_hood::unordered_map<string, vector<GameObject*>> GameObject::m_GlobalTags;
+robin_hood::unordered_map<string, TagMask> GameObject::m_TagBits;
+shared_mutex GameObject::m_TagBitsMutex;
+vector<GameObject*> GameObject::m_DestroyQueue;
+vector<GameObject*> GameObject::m_PhysicsObjects;
 
 unsigned int GameObject::GetNextID()
 {
@@ -20,122 +30,321 @@ GameObject::GameObject(string name, GameObject* parent) :
 	m_Rotation(0),
 	m_Size(Vec2 { 1, 1 }),
 	m_Position(Vec2 { 0, 0 }),
+	m_DirtyTransform(false),
+	m_TagMask(0),
+	m_SpatialCell(0),
+	m_SpatiallyIndexed(false),
 	m_PhysicsBody(nullptr),
-	m_DirtyTransform(false)
+	m_InterpolationOffset(Vec2 { 0, 0 }),
+	m_PhysicsIndex((size_t)-1),
+	m_Parent(nullptr)
 {
-	SetParent(parent);
 	m_ID = GetNextID();
 	m_IDs.emplace(m_ID, this);
+	SetParent(parent); // After ID is assigned, parent stores children by ID
 }
 
-GameObject::~GameObject() { Destroy(); }
+GameObject::~GameObject()
+{
+	if (m_ShouldDelete && !m_Destroyed)
+	{
+		// Deleted while still queued, don't leave a dangling pointer behind
+		auto it = find(m_DestroyQueue.begin(), m_DestroyQueue.end(), this);
+		if (it != m_DestroyQueue.end())
+			m_DestroyQueue.erase(it);
+	}
+
+	m_ShouldDelete = true;
+	ReleaseResources();
+
+	for (auto& pair : m_Children)
+		delete pair.second;
+	m_Children.clear();
+}
+
+void* GameObject::operator new(size_t size) { return Memory::PoolAllocator::AllocateSized(size); }
+void GameObject::operator delete(void* ptr, size_t size) { Memory::PoolAllocator::FreeSized(ptr, size); }
 
 void GameObject::Destroy()
 {
 	if (m_ShouldDelete)
 		return;
 
+	MarkForDestroy();
+	m_DestroyQueue.emplace_back(this);
+}
+
+void GameObject::MarkForDestroy()
+{
 	m_ShouldDelete = true;
+	SpatialHash::Remove(this); // Hidden from queries straight away
+	for (auto& pair : m_Children)
+		pair.second->MarkForDestroy();
+}
 
+void GameObject::CollectDestroyed(vector<GameObject*>& output)
+{
+	output.emplace_back(this);
+	for (auto& pair : m_Children)
+		pair.second->CollectDestroyed(output);
+}
+
+// Immediately releases physics body, tags & ID. Used when deleted outside of FlushDestroyQueue
+void GameObject::ReleaseResources()
+{
+	if (m_Destroyed)
+		return;
+	m_Destroyed = true;
+
+	SpatialHash::Remove(this);
 	m_IDs.erase(m_ID);
 	m_ID = (unsigned int)-1;
-	for (auto& pair : m_Children)
-	{
-		pair.second->Destroy();
-		delete pair.second;
-	}
 
-	if (m_PhysicsBody)
-	{
-		PhysicsWorld::GetBox2DWorld()->DestroyBody(m_PhysicsBody);
-		m_PhysicsBody = nullptr;
-	}
+	ReleasePhysicsBody();
 
 	for(int i = (int)m_Tags.size() - 1; i >= 0; i--)
 		RemoveTag(m_Tags[i]);
 }
 
-void GameObject::Update()
+void GameObject::FlushDestroyQueue()
 {
-	OnUpdate();
+	if (m_DestroyQueue.empty())
+		return;
+
+	// Reused between frames to avoid reallocating
+	static vector<GameObject*> roots, destroyed;
+	static vector<const string*> dirtyTags;
 
-	auto it = m_Children.begin();
-	while(it != m_Children.end())
+	// Gather every GameObject being destroyed, including children of queued GameObjects
+	for (GameObject* go : m_DestroyQueue)
 	{
-		if (!it->second->m_ShouldDelete)
+		if (go->m_Parent && go->m_Parent->m_ShouldDelete)
+			continue; // Deleted along with parent
+		roots.emplace_back(go);
+		go->CollectDestroyed(destroyed);
+	}
+	m_DestroyQueue.clear();
+
+	// Detach from surviving parents while IDs are still valid
+	for (GameObject* go : roots)
+		if (go->m_Parent)
+			go->m_Parent->m_Children.erase(go->m_ID);
+
+	for (GameObject* go : destroyed)
+	{
+		m_IDs.erase(go->m_ID);
+		go->m_ID = (unsigned int)-1;
+		go->m_Destroyed = true;
+		go->ReleasePhysicsBody();
+
+		for (const string& tag : go->m_Tags)
 		{
-			it->second->Update();
-			it++;
+			auto it = find_if(dirtyTags.begin(), dirtyTags.end(), [&](const string* dirtyTag) { return dirtyTag->compare(tag) == 0; });
+			if (it == dirtyTags.end())
+				dirtyTags.emplace_back(&tag);
 		}
-		else
-			it = m_Children.erase(it);
 	}
+
+	// Compact each affected tag list once, instead of an erase per GameObject per tag
+	for (const string* tag : dirtyTags)
+	{
+		auto it = m_GlobalTags.find(*tag);
+		if (it == m_GlobalTags.end())
+			continue;
+		vector<GameObject*>& tagged = it->second;
+		tagged.erase(remove_if(tagged.begin(), tagged.end(), [](GameObject* go) { return go->m_Destroyed; }), tagged.end());
+	}
+
+	for (GameObject* go : destroyed)
+	{
+		go->m_Tags.clear();
+		go->m_TagMask = 0;
+	}
+
+	for (GameObject* go : roots)
+		delete go;
+
+	roots.clear();
+	destroyed.clear();
+	dirtyTags.clear();
+}
+
+bool GameObject::IsDestroyed() { return m_ShouldDelete; }
+
+void GameObject::CollectActive(vector<GameObject*>& output)
+{
+	output.emplace_back(this);
+	for (auto& pair : m_Children)
+		if (!pair.second->m_ShouldDelete && !pair.second->m_Static)
+			pair.second->CollectActive(output);
+}
+
+void GameObject::Think()
+{
+	// Flattened so independent GameObjects can be spread evenly across workers
+	static vector<GameObject*> thinkers;
+	thinkers.clear();
+	CollectActive(thinkers);
+
+	JobSystem::ParallelFor((unsigned int)thinkers.size(), 32, [](unsigned int start, unsigned int end)
+	{
+		for (unsigned int i = start; i < end; i++)
+			thinkers[i]->OnThink();
+	});
+}
+
+void GameObject::Update()
+{
+	OnUpdate();
+
+	// Destroyed children are removed in FlushDestroyQueue, so the children map is never modified here
+	for (auto& pair : m_Children)
+		if (!pair.second->m_ShouldDelete && !pair.second->m_Static)
+			pair.second->Update();
 }
 
 void GameObject::Draw()
 {
 	OnDraw();
 	for (auto& pair : m_Children)
-		pair.second->Draw();
+		if (!pair.second->m_ShouldDelete)
+			pair.second->Draw();
 }
 
-void GameObject::PrePhysicsUpdate()
+void GameObject::PushTransform()
 {
-	if (m_PhysicsBody)
+	// Unchanged transforms aren't pushed, Box2D would otherwise treat the body as teleported
+	if (m_DirtyTransform)
+		m_PhysicsBody->SetTransform(
+			 m_Parent ? m_Position + m_Parent->GetPosition() : m_Position,
+			(m_Parent ? m_Rotation + m_Parent->GetRotation() : m_Rotation) * DEG2RAD
+		);
+	m_DirtyTransform = false;
+
+	OnPrePhysicsUpdate();
+}
+
+void GameObject::PullTransform()
+{
+	// Only dynamic bodies are moved by Box2D, others follow GameObject so there's nothing to read back
+	if (m_PhysicsBody->GetType() == b2_dynamicBody)
 	{
-		if (m_DirtyTransform)
-			m_PhysicsBody->SetTransform(
-				 m_Position + m_Parent->GetPosition(),
-				(m_Rotation + m_Parent->GetRotation()) * DEG2RAD
-			);
-		m_DirtyTransform = false;
-
-		OnPrePhysicsUpdate();
+		// m_Rotation = m_PhysicsBody->GetAngle() * RAD2DEG;
+		Vec2 bodyPosition = m_PhysicsBody->GetPosition();
+		unsigned int steps = PhysicsWorld::GetStepsLastFrame();
+		if (steps > 0)
+			m_InterpolationOffset = (bodyPosition - m_Position) / steps;
+		m_Position = bodyPosition;
+		if (m_SpatiallyIndexed)
+			SpatialHash::Update(this);
 	}
 
-	for (auto pair : m_Children)
-		pair.second->PrePhysicsUpdate();
+	OnPostPhysicsUpdate();
+}
+
+void GameObject::PrePhysicsUpdate()
+{
+	if (m_PhysicsBody)
+		PushTransform();
+
+	for (auto& pair : m_Children)
+		if (!pair.second->m_Static)
+			pair.second->PrePhysicsUpdate();
 }
 
 void GameObject::PostPhysicsUpdate()
 {
 	if (m_PhysicsBody)
-	{
-		// m_Rotation = m_PhysicsBody->GetAngle() * RAD2DEG;
-		m_Position = m_PhysicsBody->GetPosition();
+		PullTransform();
 
-		OnPostPhysicsUpdate();
-	}
+	for (auto& pair : m_Children)
+		if (!pair.second->m_Static)
+			pair.second->PostPhysicsUpdate();
+}
+
+// Static GameObjects, and their children, are never synced
+bool GameObject::IsStaticInHierarchy()
+{
+	for (GameObject* go = this; go; go = go->m_Parent)
+		if (go->m_Static)
+			return true;
+	return false;
+}
+
+void GameObject::PrePhysicsUpdateAll()
+{
+	for (GameObject* go : m_PhysicsObjects)
+		if (!go->IsStaticInHierarchy())
+			go->PushTransform();
+}
+
+void GameObject::PostPhysicsUpdateAll()
+{
+	for (GameObject* go : m_PhysicsObjects)
+		if (!go->IsStaticInHierarchy())
+			go->PullTransform();
+}
+
+void GameObject::ReleasePhysicsBody()
+{
+	if (!m_PhysicsBody)
+		return;
+
+	PhysicsWorld::GetBox2DWorld()->DestroyBody(m_PhysicsBody);
+	m_PhysicsBody = nullptr;
 
-	for (auto pair : m_Children)
-		pair.second->PostPhysicsUpdate();
+	// Swap with last physics object
+	GameObject* last = m_PhysicsObjects.back();
+	m_PhysicsObjects[m_PhysicsIndex] = last;
+	last->m_PhysicsIndex = m_PhysicsIndex;
+	m_PhysicsObjects.pop_back();
+	m_PhysicsIndex = (size_t)-1;
 }
 
 void GameObject::GeneratePhysicsBody(bool dynamic, float density, float friction)
 {
-	if (m_PhysicsBody)
-		PhysicsWorld::GetBox2DWorld()->DestroyBody(m_PhysicsBody);
-	
+	GeneratePhysicsBody(dynamic ? PhysicsBodyType::Dynamic : PhysicsBodyType::Static, false, density, friction);
+}
+
+void GameObject::GeneratePhysicsBody(PhysicsBodyType type, bool sensor, float density, float friction)
+{
+	GeneratePhysicsBody({ { { 0, 0 }, m_Size / 2.0f } }, type, sensor, density, friction);
+}
+
+void GameObject::GeneratePhysicsBody(const vector<PhysicsBox>& boxes, PhysicsBodyType type, bool sensor, float density, float friction)
+{
+	ReleasePhysicsBody();
+	m_InterpolationOffset = { 0, 0 };
+
 	// Create body
 	b2BodyDef body;
-	if(dynamic)
-		body.type = b2_dynamicBody;
+	switch (type)
+	{
+	case PhysicsBodyType::Static:    body.type = b2_staticBody;    break;
+	case PhysicsBodyType::Dynamic:   body.type = b2_dynamicBody;   break;
+	case PhysicsBodyType::Kinematic: body.type = b2_kinematicBody; break;
+	}
 	body.angle = m_Rotation;
 	body.userData.pointer = (uintptr_t)m_ID;
 	body.position.Set(m_Position.x, m_Position.y);
 	m_PhysicsBody = PhysicsWorld::GetBox2DWorld()->CreateBody(&body);
+	m_PhysicsIndex = m_PhysicsObjects.size();
+	m_PhysicsObjects.emplace_back(this);
 
-	// Define shape and attach
-	b2PolygonShape box;
-	box.SetAsBox(m_Size.x / 2.0f, m_Size.y / 2.0f);
-
+	// Define shapes and attach
 	b2FixtureDef fixture;
-	fixture.shape = &box;
 	fixture.density = density;
 	fixture.friction = friction;
+	fixture.isSensor = sensor;
 	fixture.userData.pointer = (uintptr_t)m_ID;
 
-	m_PhysicsBody->CreateFixture(&fixture);
+	for (const PhysicsBox& box : boxes)
+	{
+		b2PolygonShape shape;
+		shape.SetAsBox(box.HalfSize.x, box.HalfSize.y, b2Vec2(box.Centre.x, box.Centre.y), 0.0f);
+		fixture.shape = &shape;
+		m_PhysicsBody->CreateFixture(&fixture);
+	}
 }
 
 void GameObject::ReserveChildren(unsigned int count) { m_Children.reserve(count); }
@@ -191,10 +400,24 @@ GameObject* GameObject::FindChild(unsigned int id)
 }
 
 Vec2& GameObject::GetPosition() { return m_Position; }
+
+Vec2 GameObject::GetRenderPosition()
+{
+	if (!m_PhysicsBody || m_Static)
+		return m_Position;
+
+	// Interpolates from position at previous step to position at last step, by fraction of a step since.
+	// Offset is only set for dynamic bodies, others are moved every frame & have nothing to blend
+	Vec2 behind = m_InterpolationOffset * (1.0f - PhysicsWorld::GetInterpolationAlpha());
+	return m_Position - behind;
+}
 void GameObject::SetPosition(Vec2 position)
 {
 	m_Position = position;
 	m_DirtyTransform = true;
+
+	if (m_SpatiallyIndexed)
+		SpatialHash::Update(this);
 	
 	for (auto& child : m_Children)
 		child.second->m_DirtyTransform = true;
@@ -216,6 +439,9 @@ void GameObject::SetRotation(float rotation)
 std::string& GameObject::GetName() { return m_Name; }
 void GameObject::SetName(std::string name) { m_Name = name; }
 
+bool GameObject::IsStatic() { return m_Static; }
+void GameObject::SetStatic(bool isStatic) { m_Static = isStatic; }
+
 Vec2 GameObject::GetForward()
 {
 	return Vec2
@@ -231,13 +457,18 @@ void GameObject::AddTag(std::string tag)
 		m_GlobalTags.emplace(tag, vector<GameObject*>());
 	m_GlobalTags[tag].push_back(this);
 	m_Tags.emplace_back(tag);
+
+	// Tagged GameObjects are tracked by the spatial hash for neighbour queries
+	m_TagMask |= GetTagMask(tag);
+	if (!m_SpatiallyIndexed && !m_ShouldDelete)
+		SpatialHash::Insert(this);
 }
 
 void GameObject::RemoveTag(std::string tag)
 {
 	if (m_GlobalTags.find(tag) == m_GlobalTags.end())
 	{
-		cout << "Tried removing '" << tag << "' but tag doesn't exist" << endl;
+		FRAMEWORK_LOG_WARNING(m_ID, "GameObject", "Tried removing '%s' but tag doesn't exist", tag.c_str());
 		return; // Tag doesn't exist
 	}
 
@@ -256,6 +487,12 @@ void GameObject::RemoveTag(std::string tag)
 		m_Tags.erase(it);
 		break;
 	}
+
+	// Same tag may have been added more than once
+	if (!HasTag(tag))
+		m_TagMask &= ~GetTagMask(tag);
+	if (m_TagMask == 0)
+		SpatialHash::Remove(this);
 }
 
 bool GameObject::HasTag(std::string inputTag)
@@ -268,13 +505,46 @@ bool GameObject::HasTag(std::string inputTag)
 	return false;
 }
 
+TagMask GameObject::GetTagMask() { return m_TagMask; }
+
+TagMask GameObject::GetTagMask(const string& tag)
+{
+	{
+		shared_lock<shared_mutex> lock(m_TagBitsMutex);
+		auto it = m_TagBits.find(tag);
+		if (it != m_TagBits.end())
+			return it->second;
+	}
+
+	// New tag, another thread may have added it since the shared lock was released
+	unique_lock<shared_mutex> lock(m_TagBitsMutex);
+	auto it = m_TagBits.find(tag);
+	if (it != m_TagBits.end())
+		return it->second;
+
+	size_t bitIndex = m_TagBits.size();
+	assert(bitIndex < sizeof(TagMask) * 8); // Too many unique tags
+	TagMask bit = bitIndex < sizeof(TagMask) * 8 ? ((TagMask)1 << bitIndex) : 0;
+	m_TagBits.emplace(tag, bit);
+	return bit;
+}
+
+TagMask GameObject::GetTagMask(const vector<string>& tags)
+{
+	TagMask mask = 0;
+	for (const string& tag : tags)
+		mask |= GetTagMask(tag);
+	return mask;
+}
+
 b2Body* GameObject::GetPhysicsBody() { return m_PhysicsBody; }
 
 GameObject* GameObject::FromID(unsigned int id)
 {
-	if (m_IDs.find(id) == m_IDs.end())
-		return nullptr;
-	return m_IDs[id];
+	auto it = m_IDs.find(id);
+	if (it == m_IDs.end() || it->second->m_ShouldDelete)
+		return nullptr; // Doesn't exist, or is waiting to be destroyed
+	return it->second;
 }
 
 vector<GameObject*> GameObject::GetAll()
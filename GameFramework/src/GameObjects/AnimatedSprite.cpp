@@ -11,7 +11,7 @@ AnimatedSprite::AnimatedSprite(Texture texture, GameObject* parent)
 AnimatedSprite::AnimatedSprite(string texturePath, GameObject* parent)
 	: Sprite(texturePath, parent), Frame(0), MaxFrames(1), m_TimeUntilNextFrame(10000.0f) { }
 
-void AnimatedSprite::OnUpdate()
+void AnimatedSprite::OnThink()
 {
 	float delta = GetFrameTime();
 	m_TimeUntilNextFrame -= delta;
@@ -13,7 +13,7 @@ void Sprite::DrawSprite(Rectangle view)
 		return; // Texture invalid
 
 	Vec2& size = GetSize();
-	Vec2& position = GetPosition();
+	Vec2 position = GetRenderPosition();
 	DrawTexturePro(
 		m_Texture,
 		view, // Source Rect
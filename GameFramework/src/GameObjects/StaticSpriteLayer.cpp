@@ -0,0 +1,66 @@
+#include <Framework/GameObjects/StaticSpriteLayer.hpp>
+
+using namespace std;
+using namespace Framework;
+
+StaticSpriteLayer::StaticSpriteLayer(GameObject* parent) : StaticSpriteLayer("StaticSpriteLayer", parent) { }
+StaticSpriteLayer::StaticSpriteLayer(string name, GameObject* parent) :
+	GameObject(name, parent),
+	m_Textures(),
+	m_Sprites(),
+	m_Culling(false),
+	m_CullBounds({ 0, 0, 0, 0 })
+{
+	SetStatic(true);
+}
+
+uint16_t StaticSpriteLayer::GetTextureIndex(const Texture& texture)
+{
+	for (size_t i = 0; i < m_Textures.size(); i++)
+		if (m_Textures[i].id == texture.id)
+			return (uint16_t)i;
+	m_Textures.emplace_back(texture);
+	return (uint16_t)(m_Textures.size() - 1);
+}
+
+void StaticSpriteLayer::AddSprite(const Texture& texture, Rectangle view, Vec2 position, Vec2 size)
+{
+	StaticSprite sprite;
+	sprite.Source = view;
+	sprite.Destination = { position.x, position.y, size.x, size.y };
+	sprite.TextureIndex = GetTextureIndex(texture);
+	m_Sprites.emplace_back(sprite);
+}
+
+void StaticSpriteLayer::Reserve(unsigned int count) { m_Sprites.reserve(count); }
+void StaticSpriteLayer::ClearSprites() { m_Sprites.clear(); }
+unsigned int StaticSpriteLayer::GetSpriteCount() { return (unsigned int)m_Sprites.size(); }
+
+void StaticSpriteLayer::SetCullBounds(Rectangle bounds)
+{
+	m_Culling = true;
+	m_CullBounds = bounds;
+}
+
+void StaticSpriteLayer::DisableCulling() { m_Culling = false; }
+
+void StaticSpriteLayer::OnDraw()
+{
+	for (StaticSprite& sprite : m_Sprites)
+	{
+		const Rectangle& dest = sprite.Destination;
+		if (m_Culling &&
+			(dest.x + dest.width  / 2.0f < m_CullBounds.x || dest.x - dest.width  / 2.0f > m_CullBounds.x + m_CullBounds.width ||
+			 dest.y + dest.height / 2.0f < m_CullBounds.y || dest.y - dest.height / 2.0f > m_CullBounds.y + m_CullBounds.height))
+			continue; // Off screen
+
+		DrawTexturePro(
+			m_Textures[sprite.TextureIndex],
+			sprite.Source,
+			dest,
+			{ dest.width / 2.0f, dest.height / 2.0f }, // Origin
+			0.0f,
+			RAYWHITE
+		);
+	}
+}
@@ -0,0 +1,140 @@
+#include <Framework/Jobs/JobSystem.hpp>
+
+using namespace std;
+using namespace Framework;
+
+atomic_bool JobSystem::m_Running = false;
+atomic_int JobSystem::m_QueuedJobs = 0;
+vector<thread> JobSystem::m_Workers;
+vector<unique_ptr<WorkStealingQueue>> JobSystem::m_Queues;
+mutex JobSystem::m_WakeMutex;
+condition_variable JobSystem::m_WakeCondition;
+
+// Index into m_Queues for the current thread
+static thread_local unsigned int t_QueueIndex = 0;
+
+void JobSystem::Init(unsigned int workerCount)
+{
+	if (m_Running.load())
+		return;
+
+	if (workerCount == 0)
+	{
+		unsigned int hardwareThreads = thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	m_Running.store(true);
+	m_QueuedJobs.store(0);
+
+	t_QueueIndex = 0;
+	for (unsigned int i = 0; i <= workerCount; i++)
+		m_Queues.emplace_back(make_unique<WorkStealingQueue>());
+
+	for (unsigned int i = 1; i <= workerCount; i++)
+		m_Workers.emplace_back(WorkerLoop, i);
+}
+
+void JobSystem::Destroy()
+{
+	if (!m_Running.load())
+		return;
+
+	{
+		lock_guard<mutex> lock(m_WakeMutex);
+		m_Running.store(false);
+	}
+	m_WakeCondition.notify_all();
+
+	for (thread& worker : m_Workers)
+		worker.join();
+	m_Workers.clear();
+	m_Queues.clear();
+}
+
+bool JobSystem::IsRunning() { return m_Running.load(); }
+unsigned int JobSystem::GetWorkerCount() { return (unsigned int)m_Workers.size(); }
+unsigned int JobSystem::GetQueueIndex() { return t_QueueIndex; }
+
+void JobSystem::WorkerLoop(unsigned int queueIndex)
+{
+	t_QueueIndex = queueIndex;
+	while (m_Running.load())
+	{
+		if (TryExecuteJob(queueIndex))
+			continue;
+
+		unique_lock<mutex> lock(m_WakeMutex);
+		m_WakeCondition.wait(lock, []() { return m_QueuedJobs.load() > 0 || !m_Running.load(); });
+	}
+}
+
+bool JobSystem::TryExecuteJob(unsigned int queueIndex)
+{
+	Job job;
+	bool found = m_Queues[queueIndex]->Pop(job);
+
+	// Own queue is empty, steal from others starting with the next queue along
+	for (size_t i = 1; !found && i < m_Queues.size(); i++)
+		found = m_Queues[(queueIndex + i) % m_Queues.size()]->Steal(job);
+
+	if (!found)
+		return false;
+
+	m_QueuedJobs--;
+	job.Function();
+	if (job.Counter)
+		job.Counter->Pending--;
+	return true;
+}
+
+void JobSystem::Execute(function<void()> function, JobCounter& counter)
+{
+	if (!m_Running.load())
+	{
+		function();
+		return;
+	}
+
+	counter.Pending++;
+	m_Queues[GetQueueIndex()]->Push({ move(function), &counter });
+
+	{
+		lock_guard<mutex> lock(m_WakeMutex);
+		m_QueuedJobs++;
+	}
+	m_WakeCondition.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	// Help with outstanding work instead of blocking
+	while (!counter.IsFinished())
+	{
+		if (!m_Running.load() || !TryExecuteJob(GetQueueIndex()))
+			this_thread::yield();
+	}
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int batchSize, function<void(unsigned int start, unsigned int end)> function)
+{
+	if (count == 0)
+		return;
+	if (batchSize == 0)
+		batchSize = 1;
+
+	// Not worth splitting, or no workers to split between
+	if (!m_Running.load() || count <= batchSize)
+	{
+		function(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (unsigned int start = 0; start < count; start += batchSize)
+	{
+		unsigned int end = start + batchSize < count ? start + batchSize : count;
+		Execute([&function, start, end]() { function(start, end); }, counter);
+	}
+	Wait(counter);
+}
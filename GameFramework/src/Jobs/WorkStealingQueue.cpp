@@ -0,0 +1,36 @@
+#include <Framework/Jobs/WorkStealingQueue.hpp>
+
+using namespace std;
+using namespace Framework;
+
+void WorkStealingQueue::Push(Job job)
+{
+	lock_guard<mutex> lock(m_Mutex);
+	m_Jobs.emplace_back(move(job));
+}
+
+bool WorkStealingQueue::Pop(Job& output)
+{
+	lock_guard<mutex> lock(m_Mutex);
+	if (m_Jobs.empty())
+		return false;
+	output = move(m_Jobs.back());
+	m_Jobs.pop_back();
+	return true;
+}
+
+bool WorkStealingQueue::Steal(Job& output)
+{
+	lock_guard<mutex> lock(m_Mutex);
+	if (m_Jobs.empty())
+		return false;
+	output = move(m_Jobs.front());
+	m_Jobs.pop_front();
+	return true;
+}
+
+bool WorkStealingQueue::Empty()
+{
+	lock_guard<mutex> lock(m_Mutex);
+	return m_Jobs.empty();
+}
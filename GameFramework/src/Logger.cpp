@@ -0,0 +1,213 @@
+#include <cstdarg>
+#include <algorithm>
+#include <Framework/Logger.hpp>
+
+using namespace std;
+using namespace Framework;
+
+Logger::Cell* Logger::m_Buffer = nullptr;
+size_t Logger::m_Mask = 0;
+atomic_size_t Logger::m_EnqueuePosition(0);
+size_t Logger::m_DequeuePosition = 0;
+atomic_size_t Logger::m_Dropped(0);
+size_t Logger::m_ReportedDropped = 0;
+
+atomic_bool Logger::m_Running(false);
+thread Logger::m_FlushThread;
+FILE* Logger::m_File = nullptr;
+chrono::steady_clock::time_point Logger::m_StartTime = chrono::steady_clock::now();
+
+void Logger::Init(size_t capacity, string filepath)
+{
+	if (m_Running)
+		return;
+
+	size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+
+	// Each cell's sequence tells producers & the consumer whose turn it is, see Write & Drain
+	m_Buffer = new Cell[size];
+	for (size_t i = 0; i < size; i++)
+		m_Buffer[i].Sequence.store(i, memory_order_relaxed);
+	m_Mask = size - 1;
+	m_EnqueuePosition = 0;
+	m_DequeuePosition = 0;
+	m_Dropped = 0;
+	m_ReportedDropped = 0;
+
+	m_File = filepath.empty() ? nullptr : fopen(filepath.c_str(), "w");
+	m_StartTime = chrono::steady_clock::now();
+
+	m_Running = true;
+	m_FlushThread = thread(FlushLoop);
+}
+
+void Logger::Destroy()
+{
+	if (!m_Running)
+		return;
+
+	m_Running = false;
+	if (m_FlushThread.joinable())
+		m_FlushThread.join();
+	Drain(); // Anything written while thread was stopping
+
+	if (m_File)
+		fclose(m_File);
+	m_File = nullptr;
+
+	delete[] m_Buffer;
+	m_Buffer = nullptr;
+}
+
+bool Logger::IsRunning() { return m_Running; }
+size_t Logger::GetDroppedCount() { return m_Dropped; }
+
+const char* Logger::GetLevelName(LogLevel level)
+{
+	switch (level)
+	{
+	case LogLevel::Trace: return "TRACE";
+	case LogLevel::Debug: return "DEBUG";
+	case LogLevel::Info: return "INFO";
+	case LogLevel::Warning: return "WARNING";
+	case LogLevel::Error: return "ERROR";
+	default: return "";
+	}
+}
+
+void Logger::Write(LogLevel level, unsigned int agent, const char* node, const char* format, ...)
+{
+	double time = chrono::duration<double>(chrono::steady_clock::now() - m_StartTime).count();
+
+	if (!m_Running)
+	{
+		va_list args;
+		va_start(args, format);
+		Record record = { level, agent, time, "", "" };
+		snprintf(record.Node, sizeof(record.Node), "%s", node ? node : "");
+		vsnprintf(record.Message, sizeof(record.Message), format, args);
+		va_end(args);
+
+		char line[512];
+		size_t used = 0;
+		WriteRecord(record, line, sizeof(line), used);
+		fwrite(line, 1, used, stdout);
+		return;
+	}
+
+	// Claim a cell, bounded multi-producer queue
+	size_t position = m_EnqueuePosition.load(memory_order_relaxed);
+	Cell* cell = nullptr;
+	while (true)
+	{
+		cell = &m_Buffer[position & m_Mask];
+		size_t sequence = cell->Sequence.load(memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+		if (difference == 0)
+		{
+			if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+		{
+			// Full, flush thread hasn't caught up
+			m_Dropped.fetch_add(1, memory_order_relaxed);
+			return;
+		}
+		else
+			position = m_EnqueuePosition.load(memory_order_relaxed);
+	}
+
+	Record& record = cell->Entry;
+	record.Level = level;
+	record.Agent = agent;
+	record.Time = time;
+	snprintf(record.Node, sizeof(record.Node), "%s", node ? node : "");
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(record.Message, sizeof(record.Message), format, args);
+	va_end(args);
+
+	// Publish to flush thread
+	cell->Sequence.store(position + 1, memory_order_release);
+}
+
+void Logger::WriteRecord(const Record& record, char* buffer, size_t bufferSize, size_t& used)
+{
+	int length = 0;
+	if (record.Agent != NoAgent)
+		length = snprintf(buffer + used, bufferSize - used, "[%9.3f] [%s] [%s] {%u} %s\n",
+			record.Time, GetLevelName(record.Level), record.Node, record.Agent, record.Message);
+	else
+		length = snprintf(buffer + used, bufferSize - used, "[%9.3f] [%s] [%s] %s\n",
+			record.Time, GetLevelName(record.Level), record.Node, record.Message);
+
+	if (length > 0)
+		used += min((size_t)length, bufferSize - used - 1);
+}
+
+size_t Logger::Drain()
+{
+	static char output[64 * 1024];
+	const size_t MaxLine = sizeof(Record) + 64;
+
+	size_t count = 0, used = 0;
+	while (true)
+	{
+		Cell& cell = m_Buffer[m_DequeuePosition & m_Mask];
+		if (cell.Sequence.load(memory_order_acquire) != m_DequeuePosition + 1)
+			break; // Empty, or producer hasn't finished writing
+
+		WriteRecord(cell.Entry, output, sizeof(output), used);
+
+		// Hand cell back to producers for their next lap around the buffer
+		cell.Sequence.store(m_DequeuePosition + m_Mask + 1, memory_order_release);
+		m_DequeuePosition++;
+		count++;
+
+		if (sizeof(output) - used < MaxLine)
+		{
+			fwrite(output, 1, used, stdout);
+			if (m_File)
+				fwrite(output, 1, used, m_File);
+			used = 0;
+		}
+	}
+
+	size_t totalDropped = m_Dropped.load(memory_order_relaxed);
+	size_t dropped = totalDropped - m_ReportedDropped;
+	m_ReportedDropped = totalDropped;
+	if (dropped > 0)
+	{
+		int length = snprintf(output + used, sizeof(output) - used, "[Logger] Dropped %zu messages, buffer full\n", dropped);
+		if (length > 0)
+			used += min((size_t)length, sizeof(output) - used - 1);
+	}
+
+	if (used > 0)
+	{
+		fwrite(output, 1, used, stdout);
+		if (m_File)
+			fwrite(output, 1, used, m_File);
+	}
+	if (count > 0 || dropped > 0)
+	{
+		fflush(stdout);
+		if (m_File)
+			fflush(m_File);
+	}
+	return count;
+}
+
+void Logger::FlushLoop()
+{
+	while (m_Running)
+	{
+		// Sleep when idle rather than spin, messages wait at most a few milliseconds
+		if (Drain() == 0)
+			this_thread::sleep_for(chrono::milliseconds(5));
+	}
+}
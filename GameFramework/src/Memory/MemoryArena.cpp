@@ -0,0 +1,46 @@
+#include <new>
+#include <cstdint>
+#include <Framework/Memory/MemoryArena.hpp>
+
+using namespace std;
+using namespace Framework::Memory;
+
+MemoryArena::MemoryArena(size_t blockSize) : m_BlockSize(blockSize), m_Blocks() { }
+MemoryArena::~MemoryArena() { Reset(); }
+
+void* MemoryArena::Allocate(size_t size, size_t alignment)
+{
+	if (!m_Blocks.empty())
+	{
+		Block& block = m_Blocks.back();
+		uintptr_t start = (uintptr_t)(block.Data + block.Used);
+		uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t padding = (size_t)(aligned - start);
+		if (block.Used + padding + size <= block.Size)
+		{
+			block.Used += padding + size;
+			return (void*)aligned;
+		}
+	}
+
+	// Current block is full, create another large enough to hold the allocation
+	size_t blockSize = size + alignment > m_BlockSize ? size + alignment : m_BlockSize;
+	Block block = { (char*)::operator new(blockSize), blockSize, 0 };
+	m_Blocks.emplace_back(block);
+	return Allocate(size, alignment);
+}
+
+void MemoryArena::Reset()
+{
+	for (Block& block : m_Blocks)
+		::operator delete(block.Data);
+	m_Blocks.clear();
+}
+
+size_t MemoryArena::GetUsedBytes()
+{
+	size_t used = 0;
+	for (Block& block : m_Blocks)
+		used += block.Used;
+	return used;
+}
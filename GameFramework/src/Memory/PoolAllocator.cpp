@@ -0,0 +1,86 @@
+#include <new>
+#include <cassert>
+#include <Framework/Memory/PoolAllocator.hpp>
+
+using namespace std;
+using namespace Framework::Memory;
+
+PoolAllocator::PoolAllocator(size_t blockSize, size_t blocksPerChunk) :
+	m_BlockSize(blockSize < sizeof(void*) ? sizeof(void*) : blockSize),
+	m_BlocksPerChunk(blocksPerChunk > 0 ? blocksPerChunk : 1),
+	m_FreeList(nullptr),
+	m_Chunks()
+{
+	// Keep every block aligned for any fundamental type
+	m_BlockSize = (m_BlockSize + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+}
+
+PoolAllocator::~PoolAllocator()
+{
+	for (void* chunk : m_Chunks)
+		::operator delete(chunk);
+	m_Chunks.clear();
+}
+
+void PoolAllocator::AllocateChunk()
+{
+	char* chunk = (char*)::operator new(m_BlockSize * m_BlocksPerChunk);
+	m_Chunks.emplace_back(chunk);
+
+	// Thread blocks onto free list, in order so consecutive allocations are contiguous
+	for (size_t i = m_BlocksPerChunk; i > 0; i--)
+	{
+		void* block = chunk + (i - 1) * m_BlockSize;
+		*(void**)block = m_FreeList;
+		m_FreeList = block;
+	}
+}
+
+void* PoolAllocator::Allocate()
+{
+	if (!m_FreeList)
+		AllocateChunk();
+
+	void* block = m_FreeList;
+	m_FreeList = *(void**)block;
+	return block;
+}
+
+void PoolAllocator::Free(void* block)
+{
+	if (!block)
+		return;
+	*(void**)block = m_FreeList;
+	m_FreeList = block;
+}
+
+size_t PoolAllocator::GetBlockSize() { return m_BlockSize; }
+
+PoolAllocator& GetSizeClassPool(size_t size)
+{
+	static const size_t SizeClassCount = PoolAllocator::MaxSizeClass / PoolAllocator::SizeClassStep;
+	static PoolAllocator* pools[SizeClassCount] = { nullptr };
+
+	size_t index = (size + PoolAllocator::SizeClassStep - 1) / PoolAllocator::SizeClassStep - 1;
+	assert(index < SizeClassCount);
+	if (!pools[index])
+		pools[index] = new PoolAllocator((index + 1) * PoolAllocator::SizeClassStep);
+	return *pools[index];
+}
+
+void* PoolAllocator::AllocateSized(size_t size)
+{
+	if (size == 0 || size > MaxSizeClass)
+		return ::operator new(size);
+	return GetSizeClassPool(size).Allocate();
+}
+
+void PoolAllocator::FreeSized(void* block, size_t size)
+{
+	if (!block)
+		return;
+	if (size == 0 || size > MaxSizeClass)
+		::operator delete(block);
+	else
+		GetSizeClassPool(size).Free(block);
+}
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <Framework/OcclusionGrid.hpp>
+
+using namespace std;
+using namespace Framework;
+
+Vec2 OcclusionGrid::m_Origin = { 0, 0 };
+float OcclusionGrid::m_CellSize = 1.0f;
+unsigned int OcclusionGrid::m_Width = 0;
+unsigned int OcclusionGrid::m_Height = 0;
+unsigned int OcclusionGrid::m_WordsPerRow = 0;
+vector<uint64_t> OcclusionGrid::m_Bits;
+robin_hood::unordered_set<unsigned int> OcclusionGrid::m_Occluders;
+
+void OcclusionGrid::Init(Vec2 origin, unsigned int width, unsigned int height, float cellSize)
+{
+	m_Origin = origin;
+	m_CellSize = max(cellSize, 0.0001f);
+	m_Width = width;
+	m_Height = height;
+	m_WordsPerRow = (width + 63) / 64;
+	m_Bits.assign((size_t)m_WordsPerRow * height, 0);
+	m_Occluders.clear();
+}
+
+void OcclusionGrid::Destroy()
+{
+	m_Width = m_Height = m_WordsPerRow = 0;
+	m_Bits.clear();
+	m_Bits.shrink_to_fit();
+	m_Occluders.clear();
+}
+
+bool OcclusionGrid::IsInitialised() { return !m_Bits.empty(); }
+float OcclusionGrid::GetCellSize() { return m_CellSize; }
+unsigned int OcclusionGrid::GetWidth() { return m_Width; }
+unsigned int OcclusionGrid::GetHeight() { return m_Height; }
+
+void OcclusionGrid::Set(unsigned int x, unsigned int y, bool blocked)
+{
+	if (x >= m_Width || y >= m_Height)
+		return;
+
+	uint64_t& word = m_Bits[(size_t)y * m_WordsPerRow + (x >> 6)];
+	uint64_t bit = 1ull << (x & 63);
+	word = blocked ? (word | bit) : (word & ~bit);
+}
+
+bool OcclusionGrid::IsBlocked(int x, int y)
+{
+	if (x < 0 || y < 0 || (unsigned int)x >= m_Width || (unsigned int)y >= m_Height)
+		return false;
+	return (m_Bits[(size_t)y * m_WordsPerRow + (x >> 6)] >> (x & 63)) & 1ull;
+}
+
+void OcclusionGrid::AddOccluder(GameObject* go)
+{
+	if (!go || !IsInitialised())
+		return;
+
+	// Shrink slightly so bounds lying exactly on cell edges don't spill into neighbours
+	Vec2 position = go->GetPosition();
+	Vec2 halfSize = go->GetSize() / 2.0f;
+	float inset = m_CellSize * 0.01f;
+	int minX = (int)floorf((position.x - halfSize.x + inset - m_Origin.x) / m_CellSize);
+	int minY = (int)floorf((position.y - halfSize.y + inset - m_Origin.y) / m_CellSize);
+	int maxX = (int)floorf((position.x + halfSize.x - inset - m_Origin.x) / m_CellSize);
+	int maxY = (int)floorf((position.y + halfSize.y - inset - m_Origin.y) / m_CellSize);
+
+	for (int y = max(minY, 0); y <= min(maxY, (int)m_Height - 1); y++)
+		for (int x = max(minX, 0); x <= min(maxX, (int)m_Width - 1); x++)
+			Set((unsigned int)x, (unsigned int)y, true);
+
+	m_Occluders.insert(go->GetID());
+}
+
+void OcclusionGrid::AddOccluder(unsigned int id) { m_Occluders.insert(id); }
+
+bool OcclusionGrid::IsOccluder(unsigned int id) { return m_Occluders.find(id) != m_Occluders.end(); }
+
+bool OcclusionGrid::Trace(Vec2 from, Vec2 to)
+{
+	if (!IsInitialised())
+		return true;
+
+	// Grid space, one unit per cell
+	float startX = (from.x - m_Origin.x) / m_CellSize;
+	float startY = (from.y - m_Origin.y) / m_CellSize;
+	float endX = (to.x - m_Origin.x) / m_CellSize;
+	float endY = (to.y - m_Origin.y) / m_CellSize;
+
+	int x = (int)floorf(startX), y = (int)floorf(startY);
+	int lastX = (int)floorf(endX), lastY = (int)floorf(endY);
+	float dx = endX - startX, dy = endY - startY;
+	int stepX = dx > 0.0f ? 1 : -1;
+	int stepY = dy > 0.0f ? 1 : -1;
+
+	// Ray distance (0-1) to next vertical & horizontal cell edge, and between edges
+	const float Infinity = numeric_limits<float>::infinity();
+	float deltaX = dx != 0.0f ? fabsf(1.0f / dx) : Infinity;
+	float deltaY = dy != 0.0f ? fabsf(1.0f / dy) : Infinity;
+	float nextX = dx != 0.0f ? (stepX > 0 ? (x + 1 - startX) : (startX - x)) * deltaX : Infinity;
+	float nextY = dy != 0.0f ? (stepY > 0 ? (y + 1 - startY) : (startY - y)) * deltaY : Infinity;
+
+	// Every cell between the two is visited exactly once
+	int steps = abs(lastX - x) + abs(lastY - y);
+	if (IsBlocked(x, y))
+		return false;
+	for (int i = 0; i < steps; i++)
+	{
+		if (nextX < nextY)
+		{
+			x += stepX;
+			nextX += deltaX;
+		}
+		else
+		{
+			y += stepY;
+			nextY += deltaY;
+		}
+
+		if (IsBlocked(x, y))
+			return false;
+	}
+	return true;
+}
@@ -17,20 +17,9 @@ AStar::AStar(float heuristicModifier, std::function<float(AStarCell* cell, AStar
 		m_HeuristicFunc = heuristic;
 }
 
-// For sorting
-bool Framework::Pathfinding::CompareAStarCells(AStarCell* a, AStarCell* b) { return a->FScore < b->FScore; }
-
 float AStar::ManhattanHeuristic(AStarCell* cell, AStarCell* end) { return abs(cell->x - end->x) + abs(end->y - end->y); }
 float AStar::EuclideanHeuristic(AStarCell* cell, AStarCell* end) { return sqrt(pow(cell->x - end->x, 2.0f) + pow(cell->y - end->y, 2.0f)); }
 
-bool Find(const vector<AStarCell*>& set, AStarCell* value)
-{
-	for (size_t i = 0; i < set.size(); i++)
-		if (set[i] == value)
-			return true;
-	return false;
-}
-
 void AStar::StartSearch(AStarCell* start, AStarCell* end)
 {
 	m_Finished = true;
@@ -44,14 +33,10 @@ void AStar::StartSearch(AStarCell* start, AStarCell* end)
 	m_End = end;
 	m_Start = start;
 
-	m_Start->GScore = 0;
-	// m_Start->HScore = Heuristic(m_Start);
-	m_Start->FScore = m_Start->HScore;
-	m_Start->Previous = nullptr;
-	m_End->Previous = nullptr;
+	m_Nodes.clear();
+	m_Nodes[m_Start].Open = true;
 
 	m_OpenList = { m_Start };
-	m_ClosedList.clear();
 	m_CurrentPath.clear();
 }
 
@@ -81,10 +66,13 @@ void AStar::Step()
 		m_Finished = true;
 		return;
 	}
-	if(m_OpenList.size() > 1)
-		sort(m_OpenList.begin(), m_OpenList.end(), CompareAStarCells);
+	// Open cell with lowest fscore, first found on ties
+	size_t currentIndex = 0;
+	for (size_t i = 1; i < m_OpenList.size(); i++)
+		if (m_Nodes[m_OpenList[i]].FScore < m_Nodes[m_OpenList[currentIndex]].FScore)
+			currentIndex = i;
 
-	auto current = m_OpenList[0];
+	auto current = m_OpenList[currentIndex];
 
 	if (current == m_End)
 	{
@@ -93,21 +81,25 @@ void AStar::Step()
 		while (current)
 		{
 			m_CurrentPath.insert(m_CurrentPath.begin(), current);
-			current = current->Previous;
+			current = m_Nodes[current].Previous;
 		}
 		return;
 	}
 
-	m_OpenList.erase(m_OpenList.begin()); // Erase current from open list
-	m_ClosedList.emplace_back(current);
+	m_OpenList.erase(m_OpenList.begin() + currentIndex); // Erase current from open list
+	AStarNode& currentNode = m_Nodes[current];
+	currentNode.Open = false;
+	currentNode.Closed = true;
+	float currentGScore = currentNode.GScore;
 
 	for (auto& connection : current->Neighbours)
 	{
 		if (!connection || !connection->Traversable)
 			continue; // Invalid target
-		if (Find(m_ClosedList, connection))
+		AStarNode& node = m_Nodes[connection]; // May rehash, don't use currentNode past here
+		if (node.Closed)
 			continue; // Already checked target for pathing
-		float gscore = current->GScore + connection->Cost;
+		float gscore = currentGScore + connection->Cost;
 		float hscore = 0;
 		
 		if (m_HeuristicFunc)
@@ -118,14 +110,14 @@ void AStar::Step()
 
 		float fscore = gscore + hscore;
 
-		// If neighbour has already been processed, check if fscore is less than last-processing's fscore
-		if (Find(m_ClosedList, connection) && fscore >= connection->FScore)
+		// Already waiting to be processed through a path at least as short
+		if (node.Open && gscore >= node.GScore)
 			continue;
 
-		connection->GScore = gscore;
-		connection->HScore = hscore;
-		connection->FScore = fscore;
-		connection->Previous = current;
+		node.GScore = gscore;
+		node.HScore = hscore;
+		node.FScore = fscore;
+		node.Previous = current;
 
 		if (fscore > m_LargestFScore)
 			m_LargestFScore = fscore;
@@ -133,8 +125,11 @@ void AStar::Step()
 			m_SmallestFScore = fscore;
 
 		// Haven't visited target yet, add to open list for processing
-		if (!Find(m_OpenList, connection))
+		if (!node.Open)
+		{
+			node.Open = true;
 			m_OpenList.emplace_back(connection);
+		}
 	}
 
 	m_CurrentPath = { m_End };
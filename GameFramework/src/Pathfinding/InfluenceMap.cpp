@@ -0,0 +1,263 @@
+#include <cmath>
+#include <atomic>
+#include <algorithm>
+#include <Framework/Jobs/JobSystem.hpp>
+#include <Framework/Pathfinding/InfluenceMap.hpp>
+
+using namespace std;
+using namespace Framework;
+using namespace Framework::Pathfinding;
+
+// Influence below this is cleared, so fading sources settle instead of shrinking forever
+const float MinimumInfluence = 0.001f;
+
+unordered_map<string, InfluenceMap*> InfluenceMap::s_Maps;
+
+InfluenceMap::InfluenceMap(unsigned int width, unsigned int height, float cellSize, InfluenceMapArgs args) :
+	m_Args(args), m_Width(width), m_Height(height), m_CellSize(cellSize > 0.0f ? cellSize : 1.0f)
+{
+	m_Args.RowsPerJob = max(m_Args.RowsPerJob, 1u);
+
+	size_t count = (size_t)width * height;
+	m_Values.assign(count, 0.0f);
+	m_Next.assign(count, 0.0f);
+	m_Stamps.assign(count, 0.0f);
+	m_Decay.assign(count, m_Args.Decay);
+}
+
+bool InfluenceMap::GetCell(Vec2 position, unsigned int& x, unsigned int& y)
+{
+	float cellX = floorf(position.x / m_CellSize);
+	float cellY = floorf(position.y / m_CellSize);
+	if (cellX < 0.0f || cellY < 0.0f || cellX >= (float)m_Width || cellY >= (float)m_Height)
+		return false;
+	x = (unsigned int)cellX;
+	y = (unsigned int)cellY;
+	return true;
+}
+
+void InfluenceMap::SetTraversable(unsigned int x, unsigned int y, bool traversable, float cost)
+{
+	if (x >= m_Width || y >= m_Height)
+		return;
+	m_Decay[(size_t)y * m_Width + x] = traversable ? powf(m_Args.Decay, max(cost, 1.0f)) : 0.0f;
+	m_Settled = false;
+}
+
+void InfluenceMap::SetSource(unsigned int id, Vec2 position, float strength)
+{
+	unsigned int x, y;
+	if (!GetCell(position, x, y))
+	{
+		RemoveSource(id);
+		return;
+	}
+
+	Source source = { id, y * m_Width + x, strength, true };
+	auto it = m_SourceIndices.find(id);
+	if (it == m_SourceIndices.end())
+	{
+		m_SourceIndices[id] = m_Sources.size();
+		m_Sources.emplace_back(source);
+	}
+	else if (m_Sources[it->second].Cell == source.Cell && m_Sources[it->second].Strength == strength)
+	{
+		m_Sources[it->second].Touched = true;
+		return; // Unchanged
+	}
+	else
+		m_Sources[it->second] = source;
+	m_StampsDirty = true;
+}
+
+void InfluenceMap::RemoveSource(unsigned int id)
+{
+	auto it = m_SourceIndices.find(id);
+	if (it == m_SourceIndices.end())
+		return;
+
+	// Swap with last source
+	size_t index = it->second;
+	m_SourceIndices.erase(it);
+	if (index != m_Sources.size() - 1)
+	{
+		m_Sources[index] = m_Sources.back();
+		m_SourceIndices[m_Sources[index].ID] = index;
+	}
+	m_Sources.pop_back();
+	m_StampsDirty = true;
+}
+
+void InfluenceMap::RemoveStaleSources()
+{
+	// Backwards, removing swaps last source into current index
+	for (size_t i = m_Sources.size(); i-- > 0;)
+	{
+		if (m_Sources[i].Touched)
+			m_Sources[i].Touched = false;
+		else
+			RemoveSource(m_Sources[i].ID);
+	}
+}
+
+void InfluenceMap::ClearSources()
+{
+	if (m_Sources.empty())
+		return;
+	m_Sources.clear();
+	m_SourceIndices.clear();
+	m_StampsDirty = true;
+}
+
+void InfluenceMap::RebuildStamps()
+{
+	fill(m_Stamps.begin(), m_Stamps.end(), 0.0f);
+	m_SourceCells.clear();
+	for (const Source& source : m_Sources)
+	{
+		m_Stamps[source.Cell] = max(m_Stamps[source.Cell], source.Strength);
+		m_SourceCells.emplace(source.Cell, source.ID);
+	}
+	m_StampsDirty = false;
+	m_Settled = false;
+}
+
+// Writes next value of each cell in rows [start, end) from current values, returns true if any changed
+bool InfluenceMap::PropagateRows(unsigned int start, unsigned int end)
+{
+	bool changed = false;
+	for (unsigned int y = start; y < end; y++)
+	{
+		for (unsigned int x = 0; x < m_Width; x++)
+		{
+			size_t i = (size_t)y * m_Width + x;
+
+			float strongest = 0.0f;
+			if (x > 0)            strongest = max(strongest, m_Values[i - 1]);
+			if (x + 1 < m_Width)  strongest = max(strongest, m_Values[i + 1]);
+			if (y > 0)            strongest = max(strongest, m_Values[i - m_Width]);
+			if (y + 1 < m_Height) strongest = max(strongest, m_Values[i + m_Width]);
+
+			float value = max(m_Stamps[i], strongest * m_Decay[i]);
+			if (value < MinimumInfluence)
+				value = 0.0f;
+
+			m_Next[i] = value;
+			changed |= value != m_Values[i];
+		}
+	}
+	return changed;
+}
+
+void InfluenceMap::Update(unsigned int steps)
+{
+	if (m_StampsDirty)
+		RebuildStamps();
+
+	for (unsigned int step = 0; step < steps && !m_Settled; step++)
+	{
+		bool changed = false;
+		if (m_Args.Parallel)
+		{
+			// Rows only read current values & write their own next values
+			atomic_bool anyChanged { false };
+			JobSystem::ParallelFor(m_Height, m_Args.RowsPerJob, [&](unsigned int start, unsigned int end)
+			{
+				if (PropagateRows(start, end))
+					anyChanged.store(true, memory_order_relaxed);
+			});
+			changed = anyChanged.load();
+		}
+		else
+			changed = PropagateRows(0, m_Height);
+
+		m_Values.swap(m_Next);
+		m_Settled = !changed;
+	}
+}
+
+void InfluenceMap::Settle(unsigned int maxSteps) { Update(maxSteps); }
+
+float InfluenceMap::Sample(unsigned int x, unsigned int y)
+{
+	if (x >= m_Width || y >= m_Height)
+		return 0.0f;
+	return m_Values[(size_t)y * m_Width + x];
+}
+
+float InfluenceMap::Sample(Vec2 position)
+{
+	unsigned int x, y;
+	return GetCell(position, x, y) ? m_Values[(size_t)y * m_Width + x] : 0.0f;
+}
+
+Vec2 InfluenceMap::GetGradient(Vec2 position)
+{
+	unsigned int x, y;
+	if (!GetCell(position, x, y))
+		return Vec2();
+
+	// Untraversable & outside cells count as the centre value, so gradient never leads into them
+	float centre = Sample(x, y);
+	auto sampleOpen = [&](int sx, int sy)
+	{
+		if (sx < 0 || sy < 0 || (unsigned int)sx >= m_Width || (unsigned int)sy >= m_Height ||
+			m_Decay[(size_t)sy * m_Width + sx] <= 0.0f)
+			return centre;
+		return m_Values[(size_t)sy * m_Width + sx];
+	};
+
+	Vec2 gradient =
+	{
+		sampleOpen((int)x + 1, (int)y) - sampleOpen((int)x - 1, (int)y),
+		sampleOpen((int)x, (int)y + 1) - sampleOpen((int)x, (int)y - 1)
+	};
+	return gradient.x == 0.0f && gradient.y == 0.0f ? gradient : gradient.Normalized();
+}
+
+unsigned int InfluenceMap::Climb(Vec2 position, vector<Vec2>& path, unsigned int maxSteps)
+{
+	unsigned int x, y;
+	if (!GetCell(position, x, y))
+		return (unsigned int)-1;
+
+	path.emplace_back((float)x, (float)y);
+	const int Offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	for (unsigned int step = 0; step < maxSteps; step++)
+	{
+		float current = Sample(x, y);
+		unsigned int bestX = x, bestY = y;
+		float best = current;
+		for (auto& offset : Offsets)
+		{
+			unsigned int nx = x + offset[0], ny = y + offset[1]; // Wraps past zero, caught by bounds check
+			if (nx >= m_Width || ny >= m_Height || m_Decay[(size_t)ny * m_Width + nx] <= 0.0f)
+				continue;
+			float value = Sample(nx, ny);
+			if (value > best)
+			{
+				best = value;
+				bestX = nx;
+				bestY = ny;
+			}
+		}
+
+		if (bestX == x && bestY == y)
+			break; // Local maximum
+		x = bestX;
+		y = bestY;
+		path.emplace_back((float)x, (float)y);
+	}
+
+	auto it = m_SourceCells.find(y * m_Width + x);
+	return it == m_SourceCells.end() ? (unsigned int)-1 : it->second;
+}
+
+void InfluenceMap::Register(const string& name, InfluenceMap* map) { s_Maps[name] = map; }
+void InfluenceMap::Unregister(const string& name) { s_Maps.erase(name); }
+
+InfluenceMap* InfluenceMap::Find(const string& name)
+{
+	auto it = s_Maps.find(name);
+	return it == s_Maps.end() ? nullptr : it->second;
+}
@@ -1,3 +1,4 @@
+#include <cmath>
 #include <Framework/PhysicsWorld.hpp>
 
 #ifndef NDEBUG
@@ -9,10 +10,15 @@ using namespace Framework;
 b2World* PhysicsWorld::m_World;
 PhysicsWorldArgs PhysicsWorld::m_Args;
 PhysicsWorld::PhysicsDebug* PhysicsWorld::m_Debug;
+float PhysicsWorld::m_Accumulator = 0.0f;
+unsigned int PhysicsWorld::m_StepsLastFrame = 0;
 
 void PhysicsWorld::Init(PhysicsWorldArgs args)
 {
 	m_Args = args;
+	m_Args.MaxStepsPerFrame = args.MaxStepsPerFrame > 0 ? args.MaxStepsPerFrame : 1;
+	m_Accumulator = 0.0f;
+	m_StepsLastFrame = 0;
 	m_World = new b2World(args.Gravity);
 	m_Debug = new PhysicsDebug();
 
@@ -36,6 +42,32 @@ void PhysicsWorld::Step()
 	);
 }
 
+unsigned int PhysicsWorld::Step(float deltaTime)
+{
+	if (m_Args.TimeStep <= 0.0f)
+		return 0;
+	m_Accumulator += deltaTime > 0.0f ? deltaTime : 0.0f;
+
+	unsigned int steps = 0;
+	while (m_Accumulator >= m_Args.TimeStep && steps < m_Args.MaxStepsPerFrame)
+	{
+		Step();
+		m_Accumulator -= m_Args.TimeStep;
+		steps++;
+	}
+
+	// Fell behind, drop time that couldn't be simulated
+	if (m_Accumulator >= m_Args.TimeStep)
+		m_Accumulator = fmodf(m_Accumulator, m_Args.TimeStep);
+
+	m_StepsLastFrame = steps;
+	return steps;
+}
+
+float PhysicsWorld::GetInterpolationAlpha() { return m_Args.TimeStep > 0.0f ? m_Accumulator / m_Args.TimeStep : 1.0f; }
+float PhysicsWorld::GetTimeStep() { return m_Args.TimeStep; }
+unsigned int PhysicsWorld::GetStepsLastFrame() { return m_StepsLastFrame; }
+
 Color B2ToRaylibColor(const b2Color& c)
 {
 	return Color
@@ -0,0 +1,248 @@
+#include <cmath>
+#include <algorithm>
+#include <Framework/SpatialHash.hpp>
+
+using namespace std;
+using namespace Framework;
+
+float SpatialHash::m_CellSize = 100.0f;
+robin_hood::unordered_map<uint64_t, vector<GameObject*>> SpatialHash::m_Cells;
+int SpatialHash::m_MinX = 0, SpatialHash::m_MinY = 0;
+int SpatialHash::m_MaxX = -1, SpatialHash::m_MaxY = -1;
+
+uint64_t SpatialHash::GetKey(int x, int y) { return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y; }
+
+void SpatialHash::GetCellCoords(Vec2& position, int& x, int& y)
+{
+	x = (int)floorf(position.x / m_CellSize);
+	y = (int)floorf(position.y / m_CellSize);
+}
+
+float SpatialHash::GetCellSize() { return m_CellSize; }
+
+void SpatialHash::SetCellSize(float size)
+{
+	if (size <= 0.0f)
+		return;
+
+	vector<GameObject*> indexed;
+	for (auto& pair : m_Cells)
+		indexed.insert(indexed.end(), pair.second.begin(), pair.second.end());
+
+	Clear();
+	m_CellSize = size;
+	for (GameObject* go : indexed)
+		Insert(go);
+}
+
+void SpatialHash::Clear()
+{
+	for (auto& pair : m_Cells)
+		for (GameObject* go : pair.second)
+			go->m_SpatiallyIndexed = false;
+	m_Cells.clear();
+	m_MinX = m_MinY = 0;
+	m_MaxX = m_MaxY = -1;
+}
+
+void SpatialHash::AddToCell(GameObject* go, uint64_t key, int x, int y)
+{
+	m_Cells[key].emplace_back(go);
+	go->m_SpatialCell = key;
+	go->m_SpatiallyIndexed = true;
+
+	if (m_MaxX < m_MinX) // First cell
+	{
+		m_MinX = m_MaxX = x;
+		m_MinY = m_MaxY = y;
+		return;
+	}
+	m_MinX = min(m_MinX, x);
+	m_MinY = min(m_MinY, y);
+	m_MaxX = max(m_MaxX, x);
+	m_MaxY = max(m_MaxY, y);
+}
+
+void SpatialHash::RemoveFromCell(GameObject* go)
+{
+	auto it = m_Cells.find(go->m_SpatialCell);
+	if (it == m_Cells.end())
+		return;
+
+	// Order within a cell doesn't matter, swap with last element
+	vector<GameObject*>& objects = it->second;
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		if (objects[i] != go)
+			continue;
+		objects[i] = objects.back();
+		objects.pop_back();
+		break;
+	}
+
+	if (objects.empty())
+		m_Cells.erase(it);
+}
+
+void SpatialHash::Insert(GameObject* go)
+{
+	if (!go || go->m_SpatiallyIndexed)
+		return;
+	int x, y;
+	GetCellCoords(go->GetPosition(), x, y);
+	AddToCell(go, GetKey(x, y), x, y);
+}
+
+void SpatialHash::Remove(GameObject* go)
+{
+	if (!go || !go->m_SpatiallyIndexed)
+		return;
+	RemoveFromCell(go);
+	go->m_SpatiallyIndexed = false;
+}
+
+void SpatialHash::Update(GameObject* go)
+{
+	if (!go || !go->m_SpatiallyIndexed)
+		return;
+
+	int x, y;
+	GetCellCoords(go->GetPosition(), x, y);
+	uint64_t key = GetKey(x, y);
+	if (key == go->m_SpatialCell)
+		return; // Still in same cell
+
+	RemoveFromCell(go);
+	AddToCell(go, key, x, y);
+}
+
+void SpatialHash::QueryRadius(Vec2 position, float radius, TagMask mask, vector<GameObject*>& output)
+{
+	if (m_Cells.empty() || radius < 0.0f)
+		return;
+
+	float radiusSqr = radius * radius;
+	auto testCell = [&](const vector<GameObject*>& objects)
+	{
+		for (GameObject* go : objects)
+			if ((go->m_TagMask & mask) && position.DistanceSqr(go->GetPosition()) <= radiusSqr)
+				output.emplace_back(go);
+	};
+
+	Vec2 min = { position.x - radius, position.y - radius };
+	Vec2 max = { position.x + radius, position.y + radius };
+	int minX, minY, maxX, maxY;
+	GetCellCoords(min, minX, minY);
+	GetCellCoords(max, maxX, maxY);
+	minX = std::max(minX, m_MinX);
+	minY = std::max(minY, m_MinY);
+	maxX = std::min(maxX, m_MaxX);
+	maxY = std::min(maxY, m_MaxY);
+	if (minX > maxX || minY > maxY)
+		return;
+
+	// Large radius covers more cells than are occupied, cheaper to check occupied cells directly
+	if ((size_t)(maxX - minX + 1) * (size_t)(maxY - minY + 1) > m_Cells.size())
+	{
+		for (auto& pair : m_Cells)
+			testCell(pair.second);
+		return;
+	}
+
+	for (int x = minX; x <= maxX; x++)
+	{
+		for (int y = minY; y <= maxY; y++)
+		{
+			auto it = m_Cells.find(GetKey(x, y));
+			if (it != m_Cells.end())
+				testCell(it->second);
+		}
+	}
+}
+
+vector<GameObject*> SpatialHash::QueryRadius(Vec2 position, float radius, TagMask mask)
+{
+	vector<GameObject*> output;
+	QueryRadius(position, radius, mask, output);
+	return output;
+}
+
+void SpatialHash::QueryNearest(Vec2 position, unsigned int k, TagMask mask, vector<GameObject*>& output, float maxDistance, GameObject* ignore)
+{
+	if (m_Cells.empty() || k == 0)
+		return;
+
+	static thread_local vector<pair<float, GameObject*>> candidates;
+	candidates.clear();
+
+	float maxDistanceSqr = maxDistance < sqrtf(numeric_limits<float>::max()) ? maxDistance * maxDistance : numeric_limits<float>::max();
+	auto testCell = [&](const vector<GameObject*>& objects)
+	{
+		for (GameObject* go : objects)
+		{
+			if (go == ignore || !(go->m_TagMask & mask))
+				continue;
+			float distanceSqr = position.DistanceSqr(go->GetPosition());
+			if (distanceSqr <= maxDistanceSqr)
+				candidates.emplace_back(distanceSqr, go);
+		}
+	};
+	auto compare = [](const pair<float, GameObject*>& a, const pair<float, GameObject*>& b) { return a.first < b.first; };
+
+	int centreX, centreY;
+	GetCellCoords(position, centreX, centreY);
+
+	// Rings of cells past this can't hold anything
+	int maxRing = max(max(centreX - m_MinX, m_MaxX - centreX), max(centreY - m_MinY, m_MaxY - centreY));
+	if (maxDistance < numeric_limits<float>::max())
+		maxRing = min(maxRing, (int)ceilf(maxDistance / m_CellSize) + 1);
+
+	// Search outwards in square rings of cells until no unvisited cell can be closer than the k-th candidate
+	size_t visitedCells = 0;
+	for (int ring = 0; ring <= maxRing; ring++)
+	{
+		size_t ringCells = ring == 0 ? 1 : (size_t)ring * 8;
+		if (visitedCells + ringCells > m_Cells.size() * 2)
+		{
+			// Sparse population, faster to test every occupied cell
+			candidates.clear();
+			for (auto& pair : m_Cells)
+				testCell(pair.second);
+			break;
+		}
+		visitedCells += ringCells;
+
+		for (int x = centreX - ring; x <= centreX + ring; x++)
+		{
+			// Only top & bottom rows of ring include every cell, otherwise just left & right edges
+			bool edgeColumn = x == centreX - ring || x == centreX + ring;
+			for (int y = centreY - ring; y <= centreY + ring; y += (edgeColumn || ring == 0) ? 1 : ring * 2)
+			{
+				auto it = m_Cells.find(GetKey(x, y));
+				if (it != m_Cells.end())
+					testCell(it->second);
+			}
+		}
+
+		if (candidates.size() < k)
+			continue;
+
+		// Everything in the next ring is further than ring * cellSize away
+		nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end(), compare);
+		float nextRingDistance = ring * m_CellSize;
+		if (candidates[k - 1].first <= nextRingDistance * nextRingDistance)
+			break;
+	}
+
+	size_t count = min((size_t)k, candidates.size());
+	partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), compare);
+	for (size_t i = 0; i < count; i++)
+		output.emplace_back(candidates[i].second);
+}
+
+vector<GameObject*> SpatialHash::QueryNearest(Vec2 position, unsigned int k, TagMask mask, float maxDistance, GameObject* ignore)
+{
+	vector<GameObject*> output;
+	QueryNearest(position, k, mask, output, maxDistance, ignore);
+	return output;
+}
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <Framework/StaticGeometry.hpp>
+
+using namespace std;
+using namespace Framework;
+
+StaticGeometryBuilder::StaticGeometryBuilder(Vec2 origin, unsigned int width, unsigned int height, float cellSize) :
+	m_Origin(origin), m_CellSize(max(cellSize, 0.0001f)), m_Width(width), m_Height(height),
+	m_Blocked((size_t)width * height, false) { }
+
+void StaticGeometryBuilder::SetBlocked(unsigned int x, unsigned int y, bool blocked)
+{
+	if (x < m_Width && y < m_Height)
+		m_Blocked[(size_t)y * m_Width + x] = blocked;
+}
+
+bool StaticGeometryBuilder::IsBlocked(unsigned int x, unsigned int y)
+{
+	return x < m_Width && y < m_Height && m_Blocked[(size_t)y * m_Width + x];
+}
+
+vector<StaticRect> StaticGeometryBuilder::Merge()
+{
+	vector<StaticRect> rects;
+	vector<bool> used(m_Blocked.size(), false);
+	auto isFree = [&](unsigned int x, unsigned int y)
+	{
+		size_t i = (size_t)y * m_Width + x;
+		return m_Blocked[i] && !used[i];
+	};
+
+	for (unsigned int y = 0; y < m_Height; y++)
+	{
+		for (unsigned int x = 0; x < m_Width; x++)
+		{
+			if (!isFree(x, y))
+				continue;
+
+			StaticRect rect = { x, y, 1, 1 };
+			while (rect.X + rect.Width < m_Width && isFree(rect.X + rect.Width, y))
+				rect.Width++;
+
+			// Extend down while every cell below the rectangle is free
+			for (bool canGrow = true; canGrow && rect.Y + rect.Height < m_Height;)
+			{
+				for (unsigned int i = 0; i < rect.Width && canGrow; i++)
+					canGrow = isFree(rect.X + i, rect.Y + rect.Height);
+				if (canGrow)
+					rect.Height++;
+			}
+
+			for (unsigned int ry = rect.Y; ry < rect.Y + rect.Height; ry++)
+				for (unsigned int rx = rect.X; rx < rect.X + rect.Width; rx++)
+					used[(size_t)ry * m_Width + rx] = true;
+
+			rects.emplace_back(rect);
+			x += rect.Width - 1;
+		}
+	}
+	return rects;
+}
+
+vector<PhysicsBox> StaticGeometryBuilder::GetBoxes(Vec2 position)
+{
+	vector<StaticRect> rects = Merge();
+	vector<PhysicsBox> boxes;
+	boxes.reserve(rects.size());
+	for (const StaticRect& rect : rects)
+	{
+		Vec2 halfSize = { rect.Width * m_CellSize / 2.0f, rect.Height * m_CellSize / 2.0f };
+		Vec2 centre =
+		{
+			m_Origin.x + rect.X * m_CellSize + halfSize.x - position.x,
+			m_Origin.y + rect.Y * m_CellSize + halfSize.y - position.y
+		};
+		boxes.push_back({ centre, halfSize });
+	}
+	return boxes;
+}
+
+size_t StaticGeometryBuilder::Build(GameObject* owner, float friction)
+{
+	if (!owner)
+		return 0;
+
+	vector<PhysicsBox> boxes = GetBoxes(owner->GetPosition());
+	if (!boxes.empty())
+		owner->GeneratePhysicsBody(boxes, PhysicsBodyType::Static, false, 1.0f, friction);
+	return boxes.size();
+}